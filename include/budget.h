@@ -0,0 +1,53 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef BUDGET_H_
+#define BUDGET_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Per-thread CPU budgets (sporadic server).
+ *
+ * A budgeted thread may run for 'budget' ticks at its own priority in any
+ * window of 'period' ticks. Time is charged in thread_switch(); every
+ * charged chunk is handed back one period after it started. A ktimer
+ * event armed for the remaining budget forces a switch when it runs out.
+ * An exhausted thread drops to CONFIG_SCHED_BUDGET_LOW_PRIO and runs there
+ * uncharged until a replenishment arrives.
+ */
+#ifdef CONFIG_SCHED_BUDGET
+/* Set thr's budget and replenishment period in ktimer ticks. A budget of
+ * 0 removes the limit. Returns -1 if budget exceeds period, which
+ * budget_valid() checks beforehand.
+ */
+int budget_set(struct tcb *thr, uint32_t budget, uint32_t period);
+static inline int budget_valid(uint32_t budget, uint32_t period)
+{
+    return budget <= period;
+}
+void budget_switch(struct tcb *prev, struct tcb *next);
+int budget_exhausted(struct tcb *thr);
+#else
+static inline int budget_set(struct tcb *thr, uint32_t budget,
+                             uint32_t period)
+{
+    return budget ? -1 : 0;
+}
+static inline int budget_valid(uint32_t budget, uint32_t period)
+{
+    return !budget;
+}
+static inline void budget_switch(struct tcb *prev, struct tcb *next) {}
+static inline int budget_exhausted(struct tcb *thr)
+{
+    return 0;
+}
+#endif
+
+#endif /* BUDGET_H_ */
@@ -0,0 +1,40 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef CPUTIME_H_
+#define CPUTIME_H_
+
+#include <syscall.h>
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Per-thread CPU time accounting.
+ *
+ * The interval since the last accounting point is charged on every
+ * thread_switch() to the outgoing thread, and on every IRQ entry and exit
+ * to the interrupted thread or to the IRQ bucket. Time is counted in core
+ * cycles, from DWT_CYCCNT when it runs and derived from SysTick otherwise
+ * (QEMU, where DWT reads 0).
+ */
+#ifdef CONFIG_CPU_ACCOUNTING
+void cputime_switch(struct tcb *prev);
+uint32_t cputime_cycles(void);
+void cputime_irq_enter(void);
+void cputime_irq_exit(void);
+uint64_t cputime_get(cputime_t which, struct tcb *thr);
+#else
+static inline void cputime_switch(struct tcb *prev) {}
+static inline void cputime_irq_enter(void) {}
+static inline void cputime_irq_exit(void) {}
+static inline uint64_t cputime_get(cputime_t which, struct tcb *thr)
+{
+    return 0;
+}
+#endif
+
+#endif /* CPUTIME_H_ */
@@ -0,0 +1,31 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef HRTIMER_H_
+#define HRTIMER_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * High-resolution one-shot timers.
+ *
+ * A notification timer with a microsecond deadline fires from TIM2
+ * capture/compare channel 1 rather than from the ktimer tick. Deadlines
+ * further out than two ticks first wait on a ktimer event, so SysTick
+ * keeps the coarse time and the compare channel only ever covers the
+ * last stretch. Delivery happens in the TIM2 IRQ, like
+ * CONFIG_KTIMER_DIRECT_NOTIFY.
+ */
+#ifdef CONFIG_KTIMER_HIRES
+/* Notify thr with bits usec microseconds from now. Returns a non-zero
+ * handle, or 0 if usec is out of range or no timer is free.
+ */
+uint32_t hrtimer_notify(struct tcb *thr, uint32_t usec, uint32_t bits);
+#endif
+
+#endif /* HRTIMER_H_ */
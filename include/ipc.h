@@ -17,4 +17,9 @@ uint32_t ipc_deliver(void *data);
 uint32_t ipc_read_mr(tcb_t *from, int i);
 void ipc_write_mr(tcb_t *to, int i, uint32_t data);
 
+tcb_t *ipc_wait_find(tcb_t *receiver, l4_thread_t from_tid);
+void ipc_wait_dequeue(tcb_t *sender);
+void ipc_wait_abort(tcb_t *receiver);
+void ipc_timeout_cancel(tcb_t *thr);
+
 #endif /* IPC_H_ */
@@ -0,0 +1,39 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef KMUTEX_H_
+#define KMUTEX_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Priority-ceiling mutexes (immediate priority ceiling protocol).
+ *
+ * The lock word lives in user memory and an uncontended lock or unlock
+ * is one LDREX/STREX there. The owner then names the mutex in its UTCB
+ * (ceiling_mutex); whenever the scheduler runs while it does, the owner
+ * is first raised to the mutex's ceiling, so no thread at or below the
+ * ceiling can preempt it. The raise is applied lazily but takes effect
+ * before any scheduling decision, which is all the protocol observes.
+ * ceiling_raised tells the owner the kernel holds it raised; it then
+ * traps with KMUTEX_WAKE on unlock to let the held-off threads run.
+ *
+ * Under the protocol a mutex is contended only if its owner blocks
+ * inside the critical section. Waiters then sleep in the kernel, in
+ * priority order, until KMUTEX_WAKE.
+ */
+#ifdef CONFIG_KMUTEX
+void kmutex_syscall(struct tcb *caller, uint32_t *param);
+void kmutex_schedule(struct tcb *curr);
+void kmutex_thread_exit(struct tcb *thr);
+#else
+static inline void kmutex_schedule(struct tcb *curr) {}
+static inline void kmutex_thread_exit(struct tcb *thr) {}
+#endif
+
+#endif /* KMUTEX_H_ */
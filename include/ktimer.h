@@ -32,12 +32,13 @@ typedef struct ktimer_event {
     uint32_t delta;
     void *data;
 
-    /* Notification mode: if notify_thread is non-NULL, timer uses
+    /* Notification mode: if notify_thread is set, timer uses
      * async event notification instead of calling handler directly.
      * This integrates with Event-Chaining + ASYNC_SOFTIRQ subsystem.
+     * Held as a handle so an event outliving its thread is dropped.
      */
-    struct tcb *notify_thread; /* Target thread for notification */
-    uint32_t notify_bits;      /* Notification bit mask to signal */
+    tcb_handle_t notify_thread; /* Target thread for notification */
+    uint32_t notify_bits;       /* Notification bit mask to signal */
 
     /* Deadline tracking for periodic timers (prevents drift accumulation).
      * For periodic timers, deadline tracks absolute target time.
@@ -45,17 +46,51 @@ typedef struct ktimer_event {
      * This maintains phase-lock to original schedule even if softirq delayed.
      */
     uint64_t deadline; /* Absolute deadline (in ticks since boot) */
+
+    /* Timer slack: the event may fire up to slack ticks late, so that it
+     * expires together with an event already pending in that window
+     * instead of waking the system on its own.
+     */
+    uint32_t slack;
+
+    /* Notification mode: expiries that found notify_bits still pending */
+    uint32_t overrun;
+
+#ifdef CONFIG_KTIMER_WHEEL
+    /* Timing wheel linkage: pprev points at the link to this event and is
+     * NULL while the event is not queued; slot is the wheel slot holding it.
+     */
+    struct ktimer_event **pprev;
+    uint32_t expires; /* Absolute expiry, low 32 bits of the tick count */
+    uint16_t slot;
+#endif
 } ktimer_event_t;
 
 void ktimer_event_init(void);
 
 int ktimer_event_schedule(uint32_t ticks, ktimer_event_t *kte);
 
+/* Remove a pending event from the queue; events from ktimer_event_create*()
+ * are freed. Returns 0 on success, -1 if the event is not pending (already
+ * fired, or in the batch being handled; its handler still runs).
+ */
+int ktimer_event_cancel(ktimer_event_t *kte);
+
 /* Callback-based timer (traditional API) */
 ktimer_event_t *ktimer_event_create(uint32_t ticks,
                                     ktimer_event_handler_t handler,
                                     void *data);
 
+/* Schedule a caller-owned event (e.g. embedded in a TCB) in callback mode.
+ * The event must not be pending. It is never freed by ktimer: when the
+ * handler returns 0 or the event is cancelled it is simply unlinked.
+ * Returns 0 on success, -1 if ticks is 0.
+ */
+int ktimer_event_arm(ktimer_event_t *kte,
+                     uint32_t ticks,
+                     ktimer_event_handler_t handler,
+                     void *data);
+
 /* Notification-based timer (Event-Chaining + ASYNC_SOFTIRQ integration).
  * When timer expires, posts async event to notify_thread with notify_bits.
  * Thread receives notification via Event-Chaining callback.
@@ -65,6 +100,7 @@ ktimer_event_t *ktimer_event_create(uint32_t ticks,
  * @param notify_bits Notification bit mask to signal
  * @param periodic If 0, one-shot timer. If non-zero, reschedule with same
  * period.
+ * @param slack Ticks each expiry may be deferred to batch with other events
  * @return Allocated timer event, or NULL if pool exhausted
  *
  * NOTE: For one-shot timers, event is freed automatically after firing.
@@ -73,7 +109,13 @@ ktimer_event_t *ktimer_event_create(uint32_t ticks,
 ktimer_event_t *ktimer_event_create_notify(uint32_t ticks,
                                            struct tcb *notify_thread,
                                            uint32_t notify_bits,
-                                           int periodic);
+                                           int periodic,
+                                           uint32_t slack);
+
+/* The notification timer behind a user handle (SYS_TIMER_NOTIFY result)
+ * if it is pending and notifies thr, NULL otherwise.
+ */
+ktimer_event_t *ktimer_notify_lookup(uint32_t handle, struct tcb *thr);
 
 void ktimer_event_handler(void);
 
@@ -8,6 +8,13 @@
 
 #define IPC_TI_MAP_GRANT 0x8
 #define IPC_TI_GRANT 0x2
+#define IPC_TI_CONT 0x1 /* C: another receive buffer follows */
+
+/* BR0 acceptor: s bit accepts StringItems into the buffers in BR1-BR7,
+ * two words (item header, address) per simple string.
+ */
+#define IPC_ACCEPT_STRINGS 0x1
+#define IPC_BR_COUNT 8
 
 /* Total MR capacity with short message buffer:
  * MR0-MR7:   8 words in registers (ctx.regs[0-7])
@@ -38,6 +45,12 @@ typedef union {
         uint32_t header : 4;
         uint32_t base : 28;
     } map;
+    struct {
+        uint32_t header : 4;
+        uint32_t j : 5; /* number of substrings - 1 */
+        uint32_t c : 1; /* compound string */
+        uint32_t length : 22;
+    } str;
     uint32_t raw;
 } ipc_typed_item;
 
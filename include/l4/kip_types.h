@@ -54,6 +54,20 @@ typedef union {
     uint32_t raw;
 } kip_threadinfo_t;
 
+/* Kernel clock for reads without a syscall (L4_SystemClock()). The kernel
+ * makes seq odd while it updates the other fields; a reader retries when
+ * seq is odd or changed under it. Microseconds since boot are
+ * (ticks * usec_per_tick) >> KIP_CLOCK_SHIFT.
+ */
+#define KIP_CLOCK_SHIFT 16
+
+typedef struct {
+    uint32_t seq;
+    uint32_t ticks_lo; /* ktimer ticks since boot */
+    uint32_t ticks_hi;
+    uint32_t usec_per_tick; /* Fixed point, KIP_CLOCK_SHIFT bits */
+} kip_clock_t;
+
 struct kip {
     /* First 256 bytes of KIP are compliant with L4 reference
      * manual version X.2 and built in into flash (lower kip)
@@ -63,7 +77,8 @@ struct kip {
     kip_apiflags_t api_flags;
     uint32_t kern_desc_ptr;
 
-    uint32_t reserved1[17];
+    kip_clock_t clock; /* Reserved in L4 X.2 */
+    uint32_t reserved1[13];
 
     kip_memory_info_t memory_info;
 
@@ -16,7 +16,12 @@ struct utcb {
     l4_thread_t t_pager;
     /* +4w */
     uint32_t exception_handler;
-    uint32_t flags; /* COP/PREEMPT flags (not used) */
+    /* Priority-ceiling mutexes (see kmutex.h). The owner writes
+     * ceiling_mutex and ceiling_prio, the kernel alone sets ceiling_raised.
+     */
+    uint16_t ceiling_mutex; /* handle of the highest-ceiling mutex held */
+    uint8_t ceiling_prio;   /* its ceiling, for the owner (not used) */
+    uint8_t ceiling_raised; /* set when the ceiling deferred a preemption */
     uint32_t xfer_timeouts;
     uint32_t error_code;
     /* +8w */
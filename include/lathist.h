@@ -0,0 +1,39 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef LATHIST_H_
+#define LATHIST_H_
+
+#include <syscall.h>
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Per-thread latency histograms.
+ *
+ * A release is a notification that wakes a thread (notify_wake_thread()):
+ * timer notifications, posts and IRQs delivered as notifications. The
+ * time from release to the thread's next dispatch, and from that dispatch
+ * to the thread blocking again, go into log2 buckets of microseconds in
+ * the TCB. Times come from the CPU accounting clock (cputime.h).
+ *
+ * Bucket 0 holds samples under 1us, bucket b holds [2^(b-1), 2^b) us and
+ * the last one everything from 2^(LATHIST_BUCKETS-2) us up. Counts
+ * saturate rather than wrap.
+ */
+#ifdef CONFIG_LATENCY_HISTOGRAM
+void lathist_release(struct tcb *thr);
+void lathist_switch(struct tcb *prev, struct tcb *next);
+void lathist_thread_exit(struct tcb *thr);
+void lathist_syscall(struct tcb *caller, uint32_t *param);
+#else
+static inline void lathist_release(struct tcb *thr) {}
+static inline void lathist_switch(struct tcb *prev, struct tcb *next) {}
+static inline void lathist_thread_exit(struct tcb *thr) {}
+#endif
+
+#endif /* LATHIST_H_ */
@@ -136,6 +136,13 @@ mempool_t *mempool_getbyid(int mpid);
  */
 int addr_is_fpage_aligned(memptr_t addr);
 
+/*
+ * Check that [base, base + size) is covered by fpages of the address space
+ * that all grant the user access bits in rwx (MP_USER_PERM encoding).
+ * Returns 0 if accessible, -1 otherwise.
+ */
+int as_check_range(as_t *as, memptr_t base, size_t size, uint32_t rwx);
+
 int map_area(as_t *src,
              as_t *dst,
              memptr_t base,
@@ -216,6 +216,7 @@ inline void __ISB(void)
 /* System Control Block */
 #define SCB_ICSR_PENDSVCLR (uint32_t) (1 << 27) /* Clear PendSV interrupt */
 #define SCB_ICSR_PENDSVSET (uint32_t) (1 << 28) /* Set PendSV interrupt */
+#define SCB_ICSR_PENDSTSET (uint32_t) (1 << 26) /* SysTick pending */
 #define SCB_ICSR_RETTOBASE \
     (uint32_t) (1 << 11) /* Whether there are preempted active exceptions */
 
@@ -31,6 +31,11 @@
  * Implementation is in header as static inline for zero call overhead.
  */
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+/* Receiver to switch to on SVC exit, set by a successful fastpath */
+extern struct tcb *ipc_direct_switch;
+#endif
+
 /**
  * ipc_fastpath_copy_mrs() - Copy message registers to receiver
  * @saved_mrs: Saved message registers R4-R11 (MR0-MR7)
@@ -100,6 +105,10 @@ static inline int ipc_fastpath_helper(struct tcb *caller,
     l4_thread_t to_tid, from_tid;
     ipc_msg_tag_t tag;
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    ipc_direct_switch = NULL;
+#endif
+
     /* Extract IPC parameters from hardware stack (R0-R3) */
     to_tid = svc_param[REG_R0];
     from_tid = svc_param[REG_R1];
@@ -109,9 +118,9 @@ static inline int ipc_fastpath_helper(struct tcb *caller,
 
     /* Fastpath Eligibility Check */
 
-    /* Criterion 1: Simple send (to_tid valid, from_tid = NILTHREAD) */
-    if (to_tid == L4_NILTHREAD || from_tid != L4_NILTHREAD)
-        return 0; /* Slowpath: receive-only or send+receive */
+    /* Criterion 1: Send phase present (to_tid valid) */
+    if (to_tid == L4_NILTHREAD)
+        return 0; /* Slowpath: receive-only */
 
     /* Criterion 2: No typed items (no MapItems/GrantItems) */
     if (tag.s.n_typed != 0)
@@ -144,11 +153,27 @@ static inline int ipc_fastpath_helper(struct tcb *caller,
     if (tag.raw == 0x00000005)
         return 0; /* Slowpath: thread initialization */
 
+    /* Criterion 8: Receive phase (Call/ReplyWait) can block right away.
+     * A receive timeout needs a ktimer event, interrupt threads need
+     * handler bookkeeping, and a sender already queued for the caller
+     * must be picked up - all of these are left to the slowpath.
+     */
+    if (from_tid != L4_NILTHREAD) {
+        ipc_time_t rcv_timeout = {.raw = svc_param[REG_R2]};
+
+        if (rcv_timeout.raw != 0 ||
+            from_tid == TID_TO_GLOBALID(THREAD_INTERRUPT) ||
+            ipc_wait_find(caller, from_tid))
+            return 0; /* Slowpath: receive phase needs kernel work */
+    }
+
     /* All criteria met - Execute Fastpath */
 
-    /* Phase 0: Dequeue caller (will re-enqueue later) */
-    extern void sched_dequeue(struct tcb *);
-    sched_dequeue(caller);
+    /* The caller is left in its ready queue throughout (lazy queueing):
+     * a send-only caller simply keeps running, and a Call/ReplyWait
+     * caller is dropped by schedule_select() unless the reply wakes it
+     * first.
+     */
 
     /* Phase 1: Copy message registers from sender to receiver
      * - MR0-MR7:   From saved registers (R4-R11)
@@ -164,39 +189,49 @@ static inline int ipc_fastpath_helper(struct tcb *caller,
 
     /* Phase 3: Update thread states */
 
-    /* Clear timeout events (no timeout in fastpath) */
-    caller->timeout_event = 0;
-    to_thr->timeout_event = 0;
+    /* Cancel timeout events (no timeout in fastpath) */
+    if (caller->timeout_event.data)
+        ipc_timeout_cancel(caller);
+    if (to_thr->timeout_event.data)
+        ipc_timeout_cancel(to_thr);
 
-    /* Receiver becomes runnable.
-     * Only boost priority if receiver was waiting for ANY message.
-     * If waiting for a specific reply, skip boost - thread was just
-     * processing an IPC and will return to user code immediately.
-     * This prevents priority inversion where reply receivers accumulate
-     * priority 3 and starve lower-priority threads indefinitely.
+    /* Receiver becomes runnable. A reply ends its Call and takes back the
+     * scheduling context it lent the caller; a Call lends the receiver
+     * the caller's until it replies (see do_ipc()).
      */
+    if (to_thr->sc_server)
+        thread_sc_return(to_thr);
+    if (from_tid == to_thr->t_globalid)
+        thread_sc_donate(caller, to_thr);
     to_thr->state = T_RUNNABLE;
-    if (to_thr->ipc_from == L4_ANYTHREAD)
-        sched_set_priority(to_thr, SCHED_PRIO_IPC);
     to_thr->ipc_from = L4_NILTHREAD;
     sched_enqueue(to_thr);
 
-    /* Caller continues (send-only, no reply expected)
-     * Fastpath only handles from_tid==NILTHREAD (simple send).
-     * For L4_Call (send+receive), slowpath handles blocking.
-     *
-     * Restore caller's base priority before re-enqueueing.
-     * This mirrors slowpath behavior (thread_make_sender_runnable)
-     * and prevents IPC priority boost from accumulating, which would
-     * cause starvation of lower-priority threads.
+    if (from_tid == L4_NILTHREAD) {
+        /* Send-only: caller continues, still queued */
+        caller->state = T_RUNNABLE;
+    } else {
+        /* Call/ReplyWait: caller blocks in receive without leaving its
+         * ready queue. The partner is the runnable thread the switch
+         * passes to.
+         */
+        caller->state = T_RECV_BLOCKED;
+        caller->ipc_from = from_tid;
+    }
+
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    /* Phase 4: Direct process switch.
+     * If the receiver is what schedule_select() would pick anyway,
+     * svc_handler loads its context on SVC exit, skipping the PendSV
+     * exception and the second bitmap scan.
      */
-    if (caller->priority != caller->base_priority)
-        sched_set_priority(caller, caller->base_priority);
-    caller->state = T_RUNNABLE;
-    sched_enqueue(caller);
+    if (!caller->ipc_direct_off && sched_is_next(to_thr)) {
+        ipc_direct_switch = to_thr;
+        return 1;
+    }
+#endif
 
     /* Phase 4: Request context switch via PendSV */
-    /* DON'T do immediate switch - let PendSV handle it normally */
     request_schedule();
 
     return 1; /* Fastpath succeeded */
@@ -215,7 +250,8 @@ static inline int ipc_fastpath_helper(struct tcb *caller,
  *   0 if fastpath unavailable (caller must use slowpath)
  *
  * Eligibility criteria:
- * - Simple send (to_tid valid, from_tid == NILTHREAD)
+ * - Send phase (to_tid valid), optionally followed by a receive phase
+ *   with no receive timeout and no sender already queued (Call/ReplyWait)
  * - Short message (n_untyped <= 39, n_typed == 0)
  * - Receiver ready (T_RECV_BLOCKED, waiting for caller or ANYTHREAD)
  */
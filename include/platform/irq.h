@@ -6,6 +6,7 @@
 #ifndef PLATFORM_IRQ_H_
 #define PLATFORM_IRQ_H_
 
+#include <cputime.h>
 #include <error.h>
 #include <platform/cortex_m.h>
 #include <platform/link.h>
@@ -313,7 +314,9 @@ extern volatile uint32_t __irq_saved_regs[8];
     void name(void)            \
     {                          \
         irq_enter();           \
+        cputime_irq_enter();   \
         sub();                 \
+        cputime_irq_exit();    \
         request_schedule();    \
         irq_return();          \
     }
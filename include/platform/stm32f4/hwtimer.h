@@ -8,7 +8,19 @@
 
 #include <stdint.h>
 
+/* TIM2 counts the APB1 timer clock (2 x 42MHz), prescaler 0 */
+#define HWTIMER_CLOCK 84000000
+
 void hwtimer_init(void);
 uint32_t hwtimer_now(void);
 
+#ifdef CONFIG_KTIMER_HIRES
+/* Capture/compare channel 1 raises the TIM2 IRQ when the counter reaches
+ * the armed count; a count already behind the counter fires at once.
+ */
+void hwtimer_compare_arm(uint32_t count);
+void hwtimer_compare_stop(void);
+void hwtimer_compare_ack(void);
+#endif
+
 #endif /* PLATFORM_STM32F4_HWTIMER_H_ */
@@ -938,6 +938,12 @@
     (uint32_t) (1 << 14) /* TIMx trigger DMA request enable \
                           */
 
+#define TIMx_SR_UIF (uint32_t) (1 << 0)   /* TIMx update interrupt flag */
+#define TIMx_SR_CC1IF (uint32_t) (1 << 1) /* TIMx CC1 interrupt flag */
+
+#define TIMx_EGR_UG (uint32_t) (1 << 0)   /* TIMx update generation */
+#define TIMx_EGR_CC1G (uint32_t) (1 << 1) /* TIMx CC1 generation */
+
 /* SPI */
 #define SPI_CR1_CPHA (uint32_t) (1 << 0)     /* SPI clock phase */
 #define SPI_CR1_CPOL (uint32_t) (1 << 1)     /* SPI clock polarity */
@@ -0,0 +1,41 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef RELEASE_H_
+#define RELEASE_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Absolute periodic releases.
+ *
+ * RELEASE_SET arms a thread's release event at an absolute tick, and
+ * every period after it. Each release is scheduled from the previous
+ * nominal release, never from when the handler ran, so wakeup delay does
+ * not accumulate as drift. RELEASE_WAIT blocks until the next release and
+ * returns how many releases went by unwaited since the last wait, the
+ * periods the thread missed. A release that finds the thread not waiting
+ * stays pending, so an overrunning job returns from its next wait at
+ * once.
+ *
+ * Releases are delivered through RELEASE_NOTIFY_BIT, which is reserved
+ * for the purpose while releases are armed.
+ */
+#ifdef CONFIG_PERIODIC_RELEASE
+void release_syscall(struct tcb *caller, uint32_t *param);
+void release_thread_exit(struct tcb *thr);
+int release_spurious(struct tcb *thr);
+#else
+static inline void release_thread_exit(struct tcb *thr) {}
+static inline int release_spurious(struct tcb *thr)
+{
+    return 0;
+}
+#endif
+
+#endif /* RELEASE_H_ */
@@ -17,26 +17,49 @@ struct tcb;
  *
  * 32-level priority scheduler with O(1) highest-priority selection.
  * Uses Cortex-M CLZ instruction for efficient bitmap scanning.
+ * CONFIG_SCHED_PRIO_256 extends it to 256 levels with a two-level bitmap.
  *
- * Priority 0 is highest, priority 31 is lowest (idle).
- * Multiple threads at same priority use round-robin scheduling.
+ * Priority 0 is highest, SCHED_PRIO_IDLE is lowest.
+ * Multiple threads at same priority use round-robin scheduling: on yield,
+ * and with CONFIG_SCHED_RR when the running thread's timeslice expires.
  */
 
-/* Number of priority levels (0 = highest, 31 = lowest) */
+/* Number of priority levels (0 = highest, SCHED_PRIO_IDLE = lowest) */
+#ifdef CONFIG_SCHED_PRIO_256
+#define SCHED_PRIORITY_LEVELS 256
+#else
 #define SCHED_PRIORITY_LEVELS 32
+#endif
 
 /* Priority assignments for system threads */
 #define SCHED_PRIO_SOFTIRQ 0     /* Kernel softirq thread */
 #define SCHED_PRIO_INTR 1        /* Interrupt handler threads */
 #define SCHED_PRIO_ROOT 2        /* Root thread */
-#define SCHED_PRIO_IPC 3         /* IPC fast path */
 #define SCHED_PRIO_NORMAL_MIN 4  /* Normal threads start here */
-#define SCHED_PRIO_NORMAL_MAX 30 /* Normal threads end here */
-#define SCHED_PRIO_IDLE 31       /* Idle thread (always lowest) */
+#define SCHED_PRIO_NORMAL_MAX (SCHED_PRIORITY_LEVELS - 2) /* ...end here */
+#define SCHED_PRIO_IDLE (SCHED_PRIORITY_LEVELS - 1) /* Idle thread (lowest) */
 
 /* Default priority for user threads */
 #define SCHED_PRIO_DEFAULT 16
 
+#ifdef CONFIG_SCHED_TT
+/* Time-triggered windows (tt.h): the free level between the root thread
+ * and normal threads, so only the kernel and IRQ threads delay a window.
+ */
+#define SCHED_PRIO_TT 3
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+/* Earliest-deadline-first band: one level, ordered by absolute deadline */
+#define SCHED_PRIO_EDF CONFIG_SCHED_EDF_PRIO
+
+/* Notification bit posted to an EDF thread at each release */
+#define SCHED_EDF_RELEASE_BIT (1UL << 31)
+
+/* Deadline of a thread at the EDF level that has none: sorts last */
+#define SCHED_EDF_NO_DEADLINE ((uint64_t) -1)
+#endif
+
 /**
  * Linked list node for ready queue.
  * Embedded in TCB for zero-allocation enqueueing.
@@ -69,12 +92,27 @@ void sched_dequeue(struct tcb *thread);
  */
 int sched_is_queued(struct tcb *thread);
 
+/**
+ * Check if thread would be picked by schedule_select() right now.
+ * Allows IPC to switch to it without going through PendSV.
+ */
+int sched_is_next(struct tcb *thread);
+
 /**
  * Yield current thread's timeslice.
  * Rotates thread to back of its priority queue for round-robin.
  */
 void sched_yield(void);
 
+/**
+ * Give way to dest (L4 ThreadSwitch).
+ * Moves dest to the head of its level if it is ready, then yields thread.
+ *
+ * @param thread Thread giving way (the caller)
+ * @param dest   Thread to run next, NULL for a plain yield
+ */
+void sched_switch_to(struct tcb *thread, struct tcb *dest);
+
 /**
  * Change thread priority safely.
  * Handles queue migration atomically if thread is queued.
@@ -100,4 +138,56 @@ int sched_preemption_change(struct tcb *thread,
                             uint8_t new_threshold,
                             uint8_t *old_threshold);
 
+#ifdef CONFIG_SCHED_RR
+/**
+ * Round-robin quantum accounting, called on every SysTick tick.
+ * Counts down the running thread's timeslice while another thread shares
+ * its level, and on expiry leaves the rotation to the PendSV that follows.
+ */
+void sched_tick(void);
+#else
+static inline void sched_tick(void) {}
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+/**
+ * Set the relative deadline of an EDF thread, in ktimer ticks.
+ * A non-zero period releases the thread every period ticks, starting now,
+ * with its absolute deadline at the next release (implicit deadlines).
+ * Zero stops the releases. The caller moves the thread into or out of the
+ * SCHED_PRIO_EDF level.
+ *
+ * @return 0 on success, -1 if the release event could not be armed
+ */
+int sched_edf_set(struct tcb *thread, uint32_t period);
+#endif
+
+#ifdef CONFIG_KDB
+/**
+ * Read a scheduler queue statistic.
+ *
+ * @param which SCHEDSTAT_* counter (syscall.h)
+ * @return the counter, 0 for an unknown selector
+ */
+uint32_t sched_stat(uint32_t which);
+#endif
+
+#ifdef CONFIG_SCHED_ADMISSION
+/**
+ * Response-time admission control for budgeted threads.
+ * Checks that every thread with a CPU budget still finishes its budget
+ * within its period if thread declares the given priority, budget and
+ * period (ktimer ticks). A budget of 0 is always admitted.
+ *
+ * @return 0 if admitted, -1 if the task set would be unschedulable
+ */
+int sched_admit(struct tcb *thread,
+                uint8_t prio,
+                uint32_t budget,
+                uint32_t period);
+void sched_admit_remove(struct tcb *thread);
+#else
+static inline void sched_admit_remove(struct tcb *thread) {}
+#endif
+
 #endif /* SCHED_H_ */
@@ -19,12 +19,108 @@ typedef enum {
     SYS_SPACE_CONTROL,
     SYS_PROCESSOR_CONTROL,
     SYS_MEMORY_CONTROL,
-    SYS_TIMER_NOTIFY, /* Timer notification syscall */
-    SYS_NOTIFY_WAIT,  /* Wait for notification bits */
-    SYS_NOTIFY_POST,  /* Post notification bits to thread */
-    SYS_NOTIFY_CLEAR, /* Clear notification bits (non-blocking) */
+    SYS_TIMER_NOTIFY,  /* Timer notification syscall */
+    SYS_NOTIFY_WAIT,   /* Wait for notification bits */
+    SYS_NOTIFY_POST,   /* Post notification bits to thread */
+    SYS_NOTIFY_CLEAR,  /* Clear notification bits (non-blocking) */
+    SYS_CPU_TIME,      /* Read CPU time accounting (cycles) */
+    SYS_KMUTEX,        /* Priority-ceiling mutex object */
+    SYS_LATENCY,       /* Read per-thread latency histograms */
+    SYS_RELEASE,       /* Absolute periodic release */
+    SYS_TIMER_CONTROL, /* Cancel or query a notification timer */
+    SYS_SCHED_STATS,   /* Read scheduler queue statistics (KDB) */
 } syscall_t;
 
+/* SYS_CPU_TIME selectors */
+typedef enum {
+    CPUTIME_THREAD, /* One thread, excluding IRQs taken while it ran */
+    CPUTIME_USER,   /* All threads but kernel and idle */
+    CPUTIME_KERNEL, /* Kernel thread (softirqs) */
+    CPUTIME_IDLE,   /* Idle thread */
+    CPUTIME_IRQ,    /* Interrupt handlers */
+    CPUTIME_TOTAL,  /* Sum of the above buckets */
+} cputime_t;
+
+/* SYS_TIMER_NOTIFY flags (R2). With TIMER_NOTIFY_USEC, R0 is in
+ * microseconds rather than ticks; one-shot timers then fire from the
+ * high-resolution timer if CONFIG_KTIMER_HIRES is set.
+ *
+ * TIMER_NOTIFY_SLACK(n) lets each expiry come up to n ticks (or
+ * microseconds) late, so that it fires together with another timer
+ * instead of waking the system on its own. n is at most 0xFFFF.
+ */
+#define TIMER_NOTIFY_PERIODIC (1 << 0)
+#define TIMER_NOTIFY_USEC (1 << 1)
+#define TIMER_NOTIFY_SLACK_SHIFT 16
+#define TIMER_NOTIFY_SLACK(n) (((n) & 0xFFFF) << TIMER_NOTIFY_SLACK_SHIFT)
+
+/* SYS_TIMER_CONTROL operations (R0) on a timer handle from
+ * SYS_TIMER_NOTIFY (R1), which must notify the caller. ~0 if it does not,
+ * if a one-shot timer has already fired, or for a TIMER_NOTIFY_USEC
+ * timer. An expiry merges when it finds the timer's bits still pending.
+ */
+typedef enum {
+    TIMER_CANCEL,  /* Stop the timer; returns 0 */
+    TIMER_OVERRUN, /* Returns and resets the expiries that merged */
+} timer_ctl_t;
+
+/* SYS_KMUTEX operations. A mutex handle is non-zero; R0 returns 0 on
+ * success, except for KMUTEX_CREATE.
+ */
+typedef enum {
+    KMUTEX_CREATE,  /* R1: ceiling (L4 priority); returns handle, 0 = error */
+    KMUTEX_DESTROY, /* R1: handle; creator only, fails while threads wait */
+    KMUTEX_WAIT,    /* R1: handle, R2: lock word; sleep while contended */
+    KMUTEX_WAKE,    /* R1: handle; wake one waiter, drop the ceiling */
+} kmutex_op_t;
+
+/* SYS_LATENCY histograms (R1), each LATHIST_BUCKETS uint16_t counts of
+ * log2 microseconds copied to the buffer in R2. LATHIST_RESET in R1
+ * clears the histogram after reading it, for threads in the caller's
+ * address space only.
+ */
+typedef enum {
+    LATHIST_RELEASE,  /* Notification wakeup to dispatch */
+    LATHIST_RESPONSE, /* Dispatch to the next block */
+    LATHIST_KINDS,
+} lathist_t;
+
+#define LATHIST_BUCKETS 16
+#define LATHIST_RESET (1 << 8)
+
+/* SYS_SCHED_STATS counters (R0), totals since boot. Only kept with
+ * CONFIG_KDB.
+ */
+typedef enum {
+    SCHEDSTAT_CRIT,      /* Critical sections entered by queue operations */
+    SCHEDSTAT_ENQUEUE,   /* Threads linked into a ready queue */
+    SCHEDSTAT_DEQUEUE,   /* Threads unlinked from a ready queue */
+    SCHEDSTAT_LAZY_HIT,  /* Wakeups of threads still queued */
+    SCHEDSTAT_LAZY_DROP, /* Blocked threads dropped at the queue head */
+    SCHEDSTAT_ROTATE,    /* Round-robin quantum expiries acted on */
+} schedstat_t;
+
+/* SYS_RELEASE operations (R0). Release times are absolute ktimer ticks,
+ * as in the KIP clock.
+ */
+typedef enum {
+    RELEASE_SET,  /* R1/R2: first release (low/high), R3: period or 0 */
+    RELEASE_WAIT, /* Block until the next release; returns periods missed */
+    RELEASE_STOP, /* Disarm the releases */
+} release_op_t;
+
+/* Notification bit reserved for releases while they are armed. Bit 30 is
+ * the POSIX timed-wait timeout; this is the release bit of the EDF band
+ * and time-triggered slots, so RELEASE_SET fails for threads in either.
+ * It also fails while periodic releases are armed: RELEASE_STOP first.
+ */
+#define RELEASE_NOTIFY_BIT (1UL << 31)
+
+/* User lock word values shared with the kernel's KMUTEX_WAIT check */
+#define KMUTEX_UNLOCKED 0
+#define KMUTEX_LOCKED 1
+#define KMUTEX_CONTENDED 2
+
 void svc_handler(void);
 void syscall_init(void);
 void syscall_handler(void);
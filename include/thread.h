@@ -7,8 +7,10 @@
 #define THREAD_H_
 
 #include <kip.h>
+#include <ktimer.h>
 #include <lib/ktable.h>
 #include <memory.h>
+#include <syscall.h>
 #include <types.h>
 
 #include <l4/utcb.h>
@@ -24,9 +26,13 @@
  *
  * Thread ID type is declared in @file types.h and called l4_thread_t
  *
- * For Global Thread ID only high 18 bits are used and lower are reserved,
- * so we call higher meaningful value TID and use GLOBALID_TO_TID and
- * TID_TO_GLOBALID macroses for convertion.
+ * Global Thread ID holds the TID in the high 18 bits and a version in the
+ * low 14 bits, so we call higher meaningful value TID and use GLOBALID_TO_TID
+ * and TID_TO_GLOBALID macroses for convertion. The version is chosen by
+ * the creator; a lookup with a non-zero version that differs from the live
+ * thread's is a stale ID and fails. Version 0 (TID_TO_GLOBALID) is a
+ * wildcard that matches any version. There is no kernel generation count:
+ * a thread number reused with the same version is not detected as stale.
  *
  * Constants:
  *   - L4_NILTHREAD  - nilthread
@@ -40,6 +46,7 @@
 
 #define GLOBALID_TO_TID(id) (id >> 14)
 #define TID_TO_GLOBALID(id) (id << 14)
+#define GLOBALID_TO_VERSION(id) ((id) & 0x3FFF)
 
 #define THREAD_BY_TID(id) thread_by_globalid(TID_TO_GLOBALID(id))
 
@@ -65,8 +72,9 @@ typedef enum {
     T_SVC_BLOCKED,
     T_RECV_BLOCKED,
     T_SEND_BLOCKED,
-    T_NOTIFY_BLOCKED /* Blocked on SYS_NOTIFY_WAIT - distinct from IPC receive
-                      */
+    T_NOTIFY_BLOCKED, /* Blocked on SYS_NOTIFY_WAIT - distinct from IPC
+                         receive */
+    T_MUTEX_BLOCKED   /* Blocked on a contended SYS_KMUTEX mutex */
 } thread_state_t;
 
 typedef struct {
@@ -117,11 +125,129 @@ struct tcb {
 
     l4_thread_t ipc_from;
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    uint8_t ipc_direct_off; /* fastpath IPC it sends goes through PendSV */
+#endif
+
     struct tcb *t_sibling;
     struct tcb *t_parent;
     struct tcb *t_child;
+    struct tcb *t_map_next; /* next in thread_map bucket */
+
+    /* IPC timeout, armed for a timed IPC wait and cancelled as soon as
+     * the wait ends. data points back at the TCB while armed, else NULL.
+     */
+    ktimer_event_t timeout_event;
+
+#ifdef CONFIG_CPU_ACCOUNTING
+    /* Cycles run, excluding IRQs taken meanwhile (see cputime.h) */
+    uint64_t cpu_time;
+#endif
+
+#ifdef CONFIG_LATENCY_HISTOGRAM
+    /* Latency histograms (see lathist.h). Stamps are in CPU accounting
+     * cycles; lat_flags says which of them are pending.
+     */
+    uint32_t lat_release;  /* woken by a notification */
+    uint32_t lat_dispatch; /* first switch-in since the release */
+    uint32_t lat_stop;     /* last switch-out */
+    uint8_t lat_flags;
+    uint16_t lat_hist[LATHIST_KINDS][LATHIST_BUCKETS];
+#endif
+
+#ifdef CONFIG_SCHED_RR
+    /* Round-robin quantum in ktimer ticks, 0 = run until block or yield.
+     * quantum_left counts down only while another thread shares the level.
+     */
+    uint32_t timeslice;
+    uint32_t quantum_left;
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+    /* EDF band (see sched.c). edf_release is armed while edf_period is
+     * non-zero; edf_deadline orders the SCHED_PRIO_EDF ready queue.
+     */
+    ktimer_event_t edf_release;
+    uint64_t edf_deadline; /* absolute, ktimer ticks */
+    uint32_t edf_period;   /* relative deadline = period, ticks */
+    uint32_t edf_misses;   /* releases that found the thread still running */
+#endif
+
+#ifdef CONFIG_PERIODIC_RELEASE
+    /* Absolute periodic release (see release.h). rel_event.data points
+     * back at the TCB while armed, and rel_event.deadline holds the
+     * nominal time of the next release, in ktimer ticks.
+     */
+    ktimer_event_t rel_event;
+    uint32_t rel_period;     /* 0 for a single release */
+    uint16_t rel_pending;    /* releases since the last RELEASE_WAIT */
+    uint8_t rel_waiting;     /* blocked in RELEASE_WAIT */
+    uint32_t rel_count;      /* releases, in total */
+    uint32_t rel_missed;     /* periods missed, in total */
+    uint32_t rel_jitter;     /* |handler time - nominal time|, last */
+    uint32_t rel_jitter_max; /* and worst */
+#endif
+
+#ifdef CONFIG_SCHED_TT
+    uint8_t tt_windows; /* time-triggered windows owned (see tt.h) */
+#endif
+
+#ifdef CONFIG_SCHED_UPCALL
+    /* User-level scheduler (see upcall.h) and the notification bit posted
+     * to it; upcall_bit is 0 when the thread is not delegated.
+     */
+    tcb_handle_t upcall_sched;
+    uint32_t upcall_bit;
+#endif
+
+#ifdef CONFIG_SCHED_BUDGET
+    /* CPU budget (see budget.h), all in ktimer ticks; budget 0 means no
+     * limit. Each event's data points back at the TCB while armed.
+     */
+    ktimer_event_t budget_enforce;   /* fires when budget_left runs out */
+    ktimer_event_t budget_replenish; /* fires at budget_repl[0].time */
+    uint64_t budget_stamp;           /* last switch-in or charge */
+    uint32_t budget;
+    uint32_t budget_period;
+    uint32_t budget_left;
+    uint32_t budget_nrepl;
+    struct {
+        uint64_t time;
+        uint32_t amount;
+    } budget_repl[CONFIG_SCHED_BUDGET_MAX_REPL];
+#endif
 
-    uint32_t timeout_event;
+    /* Sender wait queue (see ipc.c).
+     * ipc_waiters heads the queue of threads send-blocked on this thread,
+     * ordered by priority and FIFO within a priority. ipc_link and
+     * ipc_wait_on link a send-blocked thread into its receiver's queue;
+     * ipc_wait_on is NULL when the thread is not queued.
+     */
+    struct tcb *ipc_waiters;
+    struct {
+        struct tcb *prev, *next;
+    } ipc_link;
+    struct tcb *ipc_wait_on;
+
+    /* Scheduling-context donation (see thread_sc_donate()).
+     * sc_donors heads the callers blocked in a Call on this thread, most
+     * recent first, linked through their sc_next. sc_server is the thread
+     * this one is blocked calling, NULL when it lends nothing.
+     */
+    struct tcb *sc_donors;
+    struct tcb *sc_next;
+    struct tcb *sc_server;
+
+#ifdef CONFIG_KMUTEX
+    /* Priority-ceiling mutexes (see kmutex.c). kmutex_next links a
+     * T_MUTEX_BLOCKED thread into the wait queue of mutex kmutex_wait (a
+     * handle, 0 when not waiting). kmutex_raised is set while the
+     * priority is held at a ceiling.
+     */
+    struct tcb *kmutex_next;
+    uint16_t kmutex_wait;
+    uint8_t kmutex_raised;
+#endif
 
     /* Event-chaining callback for notification objects.
      * Invoked after IPC delivery with interrupts enabled.
@@ -160,19 +286,13 @@ struct tcb {
      */
     uint8_t notify_depth;
 
-    /* Lifecycle tracking: generation counter for use-after-free detection.
-     * Incremented on thread destruction. Used to detect TCB invalidation
-     * after callback execution (debug/safety feature).
-     */
-    uint8_t notify_generation;
-
     /* Fast-path optimization: pending notification flag.
      * Set when notify_bits != 0, cleared when notify_bits == 0.
      * Allows IPC path to skip notification checks with single word read.
      */
     uint8_t notify_pending;
 
-    uint8_t _notify_pad[1]; /* Alignment padding */
+    uint8_t _notify_pad[2]; /* Alignment padding */
 
     /* Short message buffer for IPC fastpath optimization.
      * Extends fastpath coverage from 32 bytes (registers only) to 160 bytes.
@@ -213,6 +333,9 @@ void thread_init_subsys(void);
 
 tcb_t *thread_by_globalid(l4_thread_t globalid);
 
+tcb_handle_t tcb_handle(tcb_t *thr);
+tcb_t *tcb_handle_get(tcb_handle_t h);
+
 tcb_t *thread_init(l4_thread_t globalid, utcb_t *utcb);
 tcb_t *thread_create(l4_thread_t globalid, utcb_t *utcb);
 void thread_destroy(tcb_t *thr);
@@ -249,4 +372,33 @@ void thread_priority_inherit(tcb_t *waiter, tcb_t *holder);
  */
 void thread_priority_disinherit(tcb_t *holder);
 
+/**
+ * Scheduling-context donation.
+ * A Call lends the caller's priority, and with CONFIG_SCHED_BUDGET its CPU
+ * budget, to the thread it calls until the reply.
+ */
+
+/**
+ * Lend client's scheduling context to server for the duration of a Call.
+ *
+ * @param client Thread blocking in the receive phase of its Call
+ * @param server Thread the Call was delivered to
+ */
+void thread_sc_donate(tcb_t *client, tcb_t *server);
+
+/**
+ * Take back the scheduling context client lent out, if any.
+ *
+ * @param client Thread whose Call is ending (reply, timeout, destruction)
+ */
+void thread_sc_return(tcb_t *client);
+
+/**
+ * Recompute thr's effective priority from its base priority and its
+ * donors, and carry a change down the chain of threads it is calling.
+ *
+ * @param thr Thread whose base priority or donors changed
+ */
+void thread_sc_update(tcb_t *thr);
+
 #endif /* THREAD_H_ */
@@ -0,0 +1,66 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef TT_H_
+#define TT_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Time-triggered cyclic schedule.
+ *
+ * The major frame (CONFIG_SCHED_TT_MAJOR_FRAME) is split into windows
+ * declared at build time with DECLARE_TT_WINDOW (user_runtime.h); the
+ * linker collects them between tt_table_start and tt_table_end. A thread
+ * binds to windows through L4_Schedule. While one of its windows is open
+ * it runs at SCHED_PRIO_TT (sched.h) and is posted SCHED_TT_RELEASE_BIT;
+ * the rest of the frame it is parked off the ready queues. A window has
+ * one owner. One ktimer event steps through the window boundaries at
+ * fixed offsets from the frame start, so release jitter is that of the
+ * timer path alone. Time outside the windows, or left over when an owner
+ * blocks, is slack and goes to the priority bitmap as usual.
+ */
+
+/* DECLARE_TT_WINDOW entry, as laid out by the linker */
+typedef struct {
+    uint32_t offset; /* from the start of the major frame, microseconds */
+    uint32_t length; /* microseconds */
+    const char *name;
+} tt_window_t;
+
+#ifdef CONFIG_SCHED_TT
+/* Notification bit posted to an owner when its window opens */
+#define SCHED_TT_RELEASE_BIT (1UL << 31)
+
+/* Bind thr to window (1-based index into the table); the first binding
+ * starts the major frame. 0 releases all of thr's windows.
+ * Returns -1 if there is no such window or another thread owns it;
+ * tt_bindable() checks that without binding.
+ */
+int tt_bind(struct tcb *thr, uint32_t window);
+int tt_bindable(struct tcb *thr, uint32_t window);
+
+/* Whether thr owns windows but none of them is open */
+int tt_parked(struct tcb *thr);
+void kdb_show_tt(void);
+#else
+static inline int tt_bind(struct tcb *thr, uint32_t window)
+{
+    return window ? -1 : 0;
+}
+static inline int tt_bindable(struct tcb *thr, uint32_t window)
+{
+    return window ? -1 : 0;
+}
+static inline int tt_parked(struct tcb *thr)
+{
+    return 0;
+}
+#endif
+
+#endif /* TT_H_ */
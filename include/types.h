@@ -13,6 +13,26 @@ typedef uintptr_t memptr_t;
 
 typedef uint32_t l4_thread_t;
 
+/*
+ * TCB handle: a weak reference to a TCB for code that keeps a thread across
+ * points where it may be destroyed (interrupt bindings, timer events,
+ * deferred notifications, notification callbacks).
+ *
+ * The handle records the TCB slot in thread_table and the slot's generation,
+ * which thread_deinit() bumps. tcb_handle_get() (thread.h) resolves it in
+ * O(1) and returns NULL once the thread is gone, even if the slot has been
+ * reused. Generation 0 is never issued, so TCB_HANDLE_NONE never resolves.
+ */
+typedef union {
+    struct {
+        uint16_t index;
+        uint16_t gen;
+    } s;
+    uint32_t raw;
+} tcb_handle_t;
+
+#define TCB_HANDLE_NONE ((tcb_handle_t){.raw = 0})
+
 #if !defined(__cplusplus) && !defined(c_plusplus)
 typedef uint32_t bool;
 #define true 1
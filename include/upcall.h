@@ -0,0 +1,52 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef UPCALL_H_
+#define UPCALL_H_
+
+#include <types.h>
+
+/* Forward declaration */
+struct tcb;
+
+/*
+ * Scheduler upcalls (hierarchical scheduling).
+ *
+ * A thread delegated with L4_HS_Schedule names a user-level scheduler and
+ * one of its notification bits. When the thread blocks, or its CPU budget
+ * runs out, the kernel posts that bit to the scheduler, which then picks
+ * the next thread of its band with ThreadSwitch. The bit tells the
+ * scheduler which thread it was; L4_Schedule reports whether that one is
+ * still runnable. A thread counts as blocked once a scheduling decision
+ * finds it neither running nor in a syscall the kernel thread has yet to
+ * finish, so the upcall is posted before that decision is taken.
+ */
+#ifdef CONFIG_SCHED_UPCALL
+/* Delegate thr to sched, posting it notification bit 'bit' (0-31).
+ * L4_NILTHREAD removes the delegation. Returns -1 if sched does not
+ * exist or is thr itself; upcall_valid() checks that without delegating.
+ */
+int upcall_set(struct tcb *thr, l4_thread_t sched, uint32_t bit);
+int upcall_valid(struct tcb *thr, l4_thread_t sched);
+void upcall_post(struct tcb *thr);
+void upcall_schedule(struct tcb *curr);
+void upcall_switch(struct tcb *prev, struct tcb *next);
+void upcall_thread_exit(struct tcb *thr);
+#else
+static inline int upcall_set(struct tcb *thr, l4_thread_t sched, uint32_t bit)
+{
+    return sched ? -1 : 0;
+}
+static inline int upcall_valid(struct tcb *thr, l4_thread_t sched)
+{
+    return sched ? -1 : 0;
+}
+static inline void upcall_post(struct tcb *thr) {}
+static inline void upcall_schedule(struct tcb *curr) {}
+static inline void upcall_switch(struct tcb *prev, struct tcb *next) {}
+static inline void upcall_thread_exit(struct tcb *thr) {}
+#endif
+
+#endif /* UPCALL_H_ */
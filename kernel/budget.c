@@ -0,0 +1,216 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <budget.h>
+#include <debug.h>
+#include <ktimer.h>
+#include <sched.h>
+#include <thread.h>
+#include <upcall.h>
+
+extern tcb_t *kernel;
+
+/* Scheduling context of the last thread switched to other than the
+ * kernel thread: the one running, or the one the kernel thread preempted
+ * to handle a softirq.
+ */
+static tcb_t *budget_running;
+
+int budget_exhausted(tcb_t *thr)
+{
+    return thr->budget && !thr->budget_left;
+}
+
+/* Drop an exhausted thread to the background level. Donors may still
+ * hold it up, and the servers it calls drop along with it. A delegated
+ * thread's scheduler is told so it can move on to another.
+ */
+static void budget_demote(tcb_t *thr)
+{
+    thr->base_priority = CONFIG_SCHED_BUDGET_LOW_PRIO;
+    thr->preempt_threshold = CONFIG_SCHED_BUDGET_LOW_PRIO;
+    thread_sc_update(thr);
+    upcall_post(thr);
+
+    dbg_printf(DL_SCHEDULE, "BUDGET: %t exhausted\n", thr->t_globalid);
+}
+
+static void budget_restore(tcb_t *thr)
+{
+    thr->base_priority = thr->user_priority;
+    thr->preempt_threshold =
+        (thr->user_preempt_threshold < thr->inherit_priority)
+            ? thr->user_preempt_threshold
+            : thr->inherit_priority;
+    thread_sc_update(thr);
+}
+
+static uint32_t budget_replenish(void *data)
+{
+    ktimer_event_t *event = (ktimer_event_t *) data;
+    tcb_t *thr = (tcb_t *) event->data;
+    uint64_t now = ktimer_get_now();
+    uint32_t was_left, i, n;
+
+    if (!thr)
+        return 0;
+
+    was_left = thr->budget_left;
+
+    for (i = 0; i < thr->budget_nrepl && thr->budget_repl[i].time <= now;
+         ++i)
+        thr->budget_left += thr->budget_repl[i].amount;
+
+    if (thr->budget_left > thr->budget)
+        thr->budget_left = thr->budget;
+
+    for (n = 0; i < thr->budget_nrepl; ++i, ++n)
+        thr->budget_repl[n] = thr->budget_repl[i];
+    thr->budget_nrepl = n;
+
+    if (!was_left && thr->budget_left)
+        budget_restore(thr);
+
+    if (n)
+        return (thr->budget_repl[0].time > now)
+                   ? (uint32_t) (thr->budget_repl[0].time - now)
+                   : 1;
+
+    event->data = NULL;
+    return 0;
+}
+
+/* Queue amount to come back at time. The queue is in time order since
+ * chunks are charged in order; when full, the amount is folded into the
+ * latest entry, which only returns it later than due.
+ */
+static void budget_post(tcb_t *thr, uint64_t time, uint32_t amount)
+{
+    uint64_t now;
+
+    if (thr->budget_nrepl == CONFIG_SCHED_BUDGET_MAX_REPL) {
+        thr->budget_repl[thr->budget_nrepl - 1].amount += amount;
+        return;
+    }
+
+    thr->budget_repl[thr->budget_nrepl].time = time;
+    thr->budget_repl[thr->budget_nrepl].amount = amount;
+    ++thr->budget_nrepl;
+
+    if (thr->budget_replenish.data)
+        return;
+
+    now = ktimer_get_now();
+    if (ktimer_event_arm(&thr->budget_replenish,
+                         (time > now) ? (uint32_t) (time - now) : 1,
+                         budget_replenish, thr) < 0)
+        thr->budget_replenish.data = NULL;
+}
+
+/* Charge the ticks since thr was switched in */
+static void budget_charge(tcb_t *thr)
+{
+    uint64_t now = ktimer_get_now();
+    uint32_t used = (uint32_t) (now - thr->budget_stamp);
+
+    if (!used)
+        return;
+
+    if (used > thr->budget_left)
+        used = thr->budget_left;
+
+    thr->budget_left -= used;
+    budget_post(thr, thr->budget_stamp + thr->budget_period, used);
+    thr->budget_stamp = now;
+
+    if (!thr->budget_left)
+        budget_demote(thr);
+}
+
+/* Fires when the running scheduling context's budget would run out.
+ * Getting here switched to the kernel thread, which charged it; keep
+ * counting while it still has budget and is the context preempted.
+ */
+static uint32_t budget_enforce(void *data)
+{
+    ktimer_event_t *event = (ktimer_event_t *) data;
+    tcb_t *thr = (tcb_t *) event->data;
+
+    if (thr && thr == budget_running && thr->budget_left)
+        return thr->budget_left;
+
+    event->data = NULL;
+    return 0;
+}
+
+/* The scheduling context thr runs on: a server serving a Call runs on
+ * its latest caller's, followed up to the head of the call chain.
+ */
+static tcb_t *budget_sc(tcb_t *thr)
+{
+    while (thr->sc_donors)
+        thr = thr->sc_donors;
+    return thr;
+}
+
+void budget_switch(tcb_t *prev, tcb_t *next)
+{
+    tcb_t *sc = budget_running;
+
+    /* prev's time goes to the context it was switched in on, even if a
+     * reply has since given that context back.
+     */
+    if (prev && prev != kernel && sc && sc->budget_left)
+        budget_charge(sc);
+
+    /* The kernel thread is never charged, and leaves the enforcement
+     * event of the thread it preempted armed: it may be what fired.
+     */
+    if (next == kernel)
+        return;
+
+    sc = budget_sc(next);
+    budget_running = sc;
+
+    if (!sc->budget_left)
+        return;
+
+    sc->budget_stamp = ktimer_get_now();
+
+    if (!sc->budget_enforce.data &&
+        ktimer_event_arm(&sc->budget_enforce, sc->budget_left,
+                         budget_enforce, sc) < 0)
+        sc->budget_enforce.data = NULL;
+}
+
+int budget_set(tcb_t *thr, uint32_t budget, uint32_t period)
+{
+    if (budget > period)
+        return -1;
+
+    if (thr->budget_enforce.data) {
+        ktimer_event_cancel(&thr->budget_enforce);
+        thr->budget_enforce.data = NULL;
+    }
+    if (thr->budget_replenish.data) {
+        ktimer_event_cancel(&thr->budget_replenish);
+        thr->budget_replenish.data = NULL;
+    }
+
+    if (budget_exhausted(thr))
+        budget_restore(thr);
+
+    /* Nothing is charged to a removed budget; thr may be going away */
+    if (!budget && thr == budget_running)
+        budget_running = NULL;
+
+    thr->budget = budget;
+    thr->budget_period = period;
+    thr->budget_left = budget;
+    thr->budget_nrepl = 0;
+    thr->budget_stamp = ktimer_get_now();
+
+    return 0;
+}
@@ -35,7 +35,34 @@ SYMMAP-$(CONFIG_SYMMAP) = \
 TICKLESS-VERIFY-$(CONFIG_KTIMER_TICKLESS_VERIFY) = \
 	tickless-verify.o
 
-kernel-y += $(KDB-y) $(KPROBES-y) $(SYMMAP-y) $(TICKLESS-VERIFY-y)
+CPU-ACCOUNTING-$(CONFIG_CPU_ACCOUNTING) = \
+	cputime.o
+
+SCHED-BUDGET-$(CONFIG_SCHED_BUDGET) = \
+	budget.o
+
+SCHED-TT-$(CONFIG_SCHED_TT) = \
+	tt.o
+
+KMUTEX-$(CONFIG_KMUTEX) = \
+	kmutex.o
+
+SCHED-UPCALL-$(CONFIG_SCHED_UPCALL) = \
+	upcall.o
+
+LATENCY-HISTOGRAM-$(CONFIG_LATENCY_HISTOGRAM) = \
+	lathist.o
+
+KTIMER-HIRES-$(CONFIG_KTIMER_HIRES) = \
+	hrtimer.o
+
+PERIODIC-RELEASE-$(CONFIG_PERIODIC_RELEASE) = \
+	release.o
+
+kernel-y += $(KDB-y) $(KPROBES-y) $(SYMMAP-y) $(TICKLESS-VERIFY-y) \
+	$(CPU-ACCOUNTING-y) $(SCHED-BUDGET-y) $(SCHED-TT-y) $(KMUTEX-y) \
+	$(SCHED-UPCALL-y) $(LATENCY-HISTOGRAM-y) $(KTIMER-HIRES-y) \
+	$(PERIODIC-RELEASE-y)
 
 # Unified notification system (CORE - always enabled)
 # - Basic notifications (atomic bit operations)
@@ -0,0 +1,159 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <cputime.h>
+#include <debug.h>
+#include <init_hook.h>
+#include <ktimer.h>
+#include <platform/cortex_m.h>
+#include <platform/irq-latency.h>
+#include <platform/irq.h>
+#include <thread.h>
+
+extern tcb_t *kernel;
+extern tcb_t *idle;
+
+/* System-wide buckets, indexed by cputime_t (CPUTIME_THREAD unused) */
+static uint64_t cputime_bucket[CPUTIME_TOTAL];
+
+/* Cycle count at the last accounting point */
+static uint32_t cputime_stamp;
+
+/* IRQ nesting depth; time is charged to CPUTIME_IRQ while non-zero */
+static uint32_t cputime_irq_depth;
+
+static int cputime_dwt;
+
+/* Current time in core cycles, modulo 2^32. Accounting points are at most
+ * one SysTick period apart, far below the 2^32-cycle wrap.
+ * Called with SysTick masked.
+ */
+uint32_t cputime_cycles(void)
+{
+    uint32_t ticks, elapsed;
+
+    if (cputime_dwt)
+        return *DWT_CYCCNT;
+
+    /* Whole ticks plus the elapsed part of the current one. A wrap whose
+     * interrupt is still pending already counts as a tick. During a
+     * tickless sleep the period is longer than a heartbeat; the part past
+     * the heartbeat is picked up at wakeup, when ktimer_now catches up.
+     */
+    ticks = (uint32_t) ktimer_get_now();
+    elapsed = *SYSTICK_VAL;
+    if (*SCB_ICSR & SCB_ICSR_PENDSTSET) {
+        elapsed = *SYSTICK_VAL;
+        ++ticks;
+    }
+
+    elapsed = (elapsed < CONFIG_KTIMER_HEARTBEAT)
+                  ? CONFIG_KTIMER_HEARTBEAT - 1 - elapsed
+                  : 0;
+
+    return ticks * CONFIG_KTIMER_HEARTBEAT + elapsed;
+}
+
+/* Charge the time since the last accounting point to thr, or to the IRQ
+ * bucket inside an interrupt.
+ */
+static void cputime_charge(tcb_t *thr)
+{
+    uint32_t now = cputime_cycles();
+    uint32_t delta = now - cputime_stamp;
+
+    cputime_stamp = now;
+
+    if (cputime_irq_depth) {
+        cputime_bucket[CPUTIME_IRQ] += delta;
+        return;
+    }
+
+    if (!thr)
+        return;
+
+    thr->cpu_time += delta;
+
+    if (thr == kernel)
+        cputime_bucket[CPUTIME_KERNEL] += delta;
+    else if (thr == idle)
+        cputime_bucket[CPUTIME_IDLE] += delta;
+    else
+        cputime_bucket[CPUTIME_USER] += delta;
+}
+
+/* Every accounted entry point runs at SysTick priority or below; masking
+ * from SysTick up keeps zero-latency ISRs running.
+ */
+void cputime_switch(tcb_t *prev)
+{
+    uint32_t basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+
+    cputime_charge(prev);
+    irq_restore_basepri(basepri);
+}
+
+void cputime_irq_enter(void)
+{
+    uint32_t basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+
+    cputime_charge((tcb_t *) current);
+    ++cputime_irq_depth;
+    irq_restore_basepri(basepri);
+}
+
+void cputime_irq_exit(void)
+{
+    uint32_t basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+
+    cputime_charge((tcb_t *) current);
+    --cputime_irq_depth;
+    irq_restore_basepri(basepri);
+}
+
+uint64_t cputime_get(cputime_t which, tcb_t *thr)
+{
+    uint64_t total = 0;
+    uint32_t basepri;
+
+    /* Bring the running thread up to date first */
+    basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+    cputime_charge((tcb_t *) current);
+
+    switch (which) {
+    case CPUTIME_THREAD:
+        total = thr ? thr->cpu_time : 0;
+        break;
+    case CPUTIME_TOTAL:
+        for (int i = CPUTIME_USER; i < CPUTIME_TOTAL; ++i)
+            total += cputime_bucket[i];
+        break;
+    default:
+        if (which < CPUTIME_TOTAL)
+            total = cputime_bucket[which];
+    }
+
+    irq_restore_basepri(basepri);
+    return total;
+}
+
+/* DWT is enabled by latency_init() at platform level. QEMU does not
+ * emulate it and the counter stays at 0; fall back to SysTick then.
+ */
+static void cputime_init(void)
+{
+    uint32_t before = *DWT_CYCCNT;
+
+    for (volatile int i = 0; i < 100; i++)
+        ;
+
+    cputime_dwt = (*DWT_CYCCNT != before);
+    cputime_stamp = cputime_cycles();
+
+    dbg_printf(DL_KDB, "CPU accounting: %s\n",
+               cputime_dwt ? "DWT cycle counter" : "SysTick");
+}
+
+INIT_HOOK(cputime_init, INIT_LEVEL_KERNEL);
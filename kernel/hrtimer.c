@@ -0,0 +1,145 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include INC_PLAT(hwtimer.h)
+#include INC_PLAT(nvic.h)
+#include INC_PLAT(systick.h)
+
+#include <debug.h>
+#include <hrtimer.h>
+#include <init_hook.h>
+#include <ktimer.h>
+#include <lib/ktable.h>
+#include <notification.h>
+#include <platform/irq.h>
+#include <thread.h>
+
+#define HRTIMER_PER_US (HWTIMER_CLOCK / 1000000)
+
+/* One ktimer tick in TIM2 counts */
+#define HRTIMER_TICK (CONFIG_KTIMER_HEARTBEAT / (CORE_CLOCK / HWTIMER_CLOCK))
+
+/* Deadlines stay within half the counter range to compare as signed */
+#define HRTIMER_MAX_US (0x7FFFFFFF / HRTIMER_PER_US)
+
+typedef struct hrtimer {
+    struct hrtimer *next;
+    ktimer_event_t coarse; /* SysTick leg of a far deadline */
+    tcb_handle_t thread;
+    uint32_t bits;
+    uint32_t expires; /* TIM2 count */
+} hrtimer_t;
+
+DECLARE_KTABLE(hrtimer_t, hrtimer_table, CONFIG_KTIMER_HIRES_EVENTS);
+
+/* Timers on the compare channel, earliest first */
+static hrtimer_t *hrtimer_queue;
+
+static void hrtimer_queue_insert(hrtimer_t *hrt)
+{
+    uint32_t flags = irq_save_flags();
+    hrtimer_t **p = &hrtimer_queue;
+
+    while (*p && (int32_t) ((*p)->expires - hrt->expires) <= 0)
+        p = &(*p)->next;
+
+    hrt->next = *p;
+    *p = hrt;
+
+    if (hrtimer_queue == hrt)
+        hwtimer_compare_arm(hrt->expires);
+
+    irq_restore_flags(flags);
+}
+
+/* The SysTick leg is over: the rest is up to the compare channel */
+static uint32_t hrtimer_coarse_handler(void *data)
+{
+    hrtimer_queue_insert((hrtimer_t *) data);
+    return 0;
+}
+
+static void __hrtimer_handler(void)
+{
+    hrtimer_t *hrt;
+    tcb_t *thr;
+
+    hwtimer_compare_ack();
+
+    while ((hrt = hrtimer_queue) &&
+           (int32_t) (hrt->expires - hwtimer_now()) <= 0) {
+        hrtimer_queue = hrt->next;
+
+        /* Target destroyed since the timer was armed: drop it */
+        thr = tcb_handle_get(hrt->thread);
+        if (thr) {
+            notification_signal(thr, hrt->bits);
+            notify_wake_thread(thr);
+        }
+        ktable_free(&hrtimer_table, hrt);
+    }
+
+    if (hrtimer_queue)
+        hwtimer_compare_arm(hrtimer_queue->expires);
+    else
+        hwtimer_compare_stop();
+}
+
+IRQ_HANDLER(TIM2_HANDLER, __hrtimer_handler);
+
+uint32_t hrtimer_notify(tcb_t *thr, uint32_t usec, uint32_t bits)
+{
+    uint32_t flags, counts, ticks;
+    hrtimer_t *hrt;
+
+    if (!thr || !bits || usec > HRTIMER_MAX_US)
+        return 0;
+
+    /* The TIM2 IRQ frees timers */
+    flags = irq_save_flags();
+    hrt = (hrtimer_t *) ktable_alloc(&hrtimer_table);
+    irq_restore_flags(flags);
+
+    if (!hrt)
+        return 0;
+
+    counts = usec * HRTIMER_PER_US;
+    hrt->thread = tcb_handle(thr);
+    hrt->bits = bits;
+    hrt->expires = hwtimer_now() + counts;
+
+    /* A ticks - 1 tick event fires one to two ticks before the deadline.
+     * Chained with an earlier batch (CONFIG_KTIMER_MINTICKS), it fires
+     * earlier still, which only makes the compare leg longer.
+     */
+    ticks = counts / HRTIMER_TICK;
+    if (ticks < 2) {
+        hrtimer_queue_insert(hrt);
+    } else if (ktimer_event_arm(&hrt->coarse, ticks - 1,
+                                hrtimer_coarse_handler, hrt) < 0) {
+        flags = irq_save_flags();
+        ktable_free(&hrtimer_table, hrt);
+        irq_restore_flags(flags);
+        return 0;
+    }
+
+    dbg_printf(DL_KTIMER, "HRT: %p for %t bits=0x%x in %dus (%d ticks)\n",
+               hrt, thr->t_globalid, bits, usec, ticks);
+
+    return (uint32_t) hrt;
+}
+
+static void hrtimer_init(void)
+{
+    ktable_init(&hrtimer_table);
+    hwtimer_init();
+
+    /* Masked along with the kernel, but ahead of user IRQs */
+    NVIC_SetPriority(TIM2_IRQn, IRQ_PRIO_KERNEL_MASK >> 4, 0);
+    NVIC_ClearPendingIRQ(TIM2_IRQn);
+    NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+INIT_HOOK(hrtimer_init, INIT_LEVEL_KERNEL);
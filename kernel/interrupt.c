@@ -20,7 +20,9 @@ void __interrupt_handler(int n);
     void nvic_handler##n(void)          \
     {                                   \
         irq_enter();                    \
+        cputime_irq_enter();            \
         __interrupt_handler(n);         \
+        cputime_irq_exit();             \
         request_schedule();             \
         irq_return();                   \
     }
@@ -40,8 +42,7 @@ typedef void (*irq_handler_t)(void);
 #define IS_VALID_IRQ_NUM(irq) ((irq) < INVALID_IRQ_NUM)
 
 struct user_irq {
-    l4_thread_t
-        thr_id; /* Thread global ID (not pointer - prevents use-after-free) */
+    tcb_handle_t thr; /* Handler thread (handle - prevents use-after-free) */
     int irq;
     uint16_t action;
     uint16_t priority;
@@ -108,7 +109,7 @@ static struct user_irq *user_irq_create_default(int irq)
 {
     if (IS_VALID_IRQ_NUM(irq)) {
         struct user_irq *uirq = ktable_alloc(&user_irq_table);
-        uirq->thr_id = L4_NILTHREAD;
+        uirq->thr = TCB_HANDLE_NONE;
         uirq->irq = irq;
         uirq->action = 0;
         uirq->priority = 0;
@@ -142,16 +143,15 @@ static void user_irq_release(int irq)
 
 static void irq_handler_ipc(struct user_irq *uirq)
 {
-    if (!uirq || uirq->thr_id == L4_NILTHREAD)
+    if (!uirq || !uirq->thr.raw)
         return;
 
     /* Safe thread lookup - handle thread destruction */
-    tcb_t *thr = thread_by_globalid(uirq->thr_id);
+    tcb_t *thr = tcb_handle_get(uirq->thr);
     if (!thr) {
         /* Thread destroyed - drop IRQ safely */
-        dbg_printf(DL_NOTIFICATIONS,
-                   "IRQ: Dropping IRQ %d for dead thread %t\n", uirq->irq,
-                   uirq->thr_id);
+        dbg_printf(DL_NOTIFICATIONS, "IRQ: Dropping IRQ %d for dead thread\n",
+                   uirq->irq);
         return;
     }
 
@@ -189,16 +189,15 @@ static void irq_handler_ipc(struct user_irq *uirq)
  */
 static void irq_handler_notify(struct user_irq *uirq)
 {
-    if (!uirq || uirq->thr_id == L4_NILTHREAD)
+    if (!uirq || !uirq->thr.raw)
         return;
 
     /* Safe thread lookup - handle thread destruction */
-    tcb_t *thr = thread_by_globalid(uirq->thr_id);
+    tcb_t *thr = tcb_handle_get(uirq->thr);
     if (!thr) {
         /* Thread destroyed - drop IRQ safely */
-        dbg_printf(DL_NOTIFICATIONS,
-                   "IRQ: Dropping IRQ %d for dead thread %t\n", uirq->irq,
-                   uirq->thr_id);
+        dbg_printf(DL_NOTIFICATIONS, "IRQ: Dropping IRQ %d for dead thread\n",
+                   uirq->irq);
         return;
     }
 
@@ -233,7 +232,7 @@ static int irq_handler_enable(int irq)
 
     assert((intptr_t) uirq);
 
-    if (uirq->thr_id == L4_NILTHREAD)
+    if (!uirq->thr.raw)
         return -1;
 
     /* Choose delivery method based on IRQ flags */
@@ -244,7 +243,7 @@ static int irq_handler_enable(int irq)
         /* Traditional: full IPC delivery (default) */
 
         /* Safe thread lookup for IPC path */
-        tcb_t *thr = thread_by_globalid(uirq->thr_id);
+        tcb_t *thr = tcb_handle_get(uirq->thr);
         if (!thr)
             return -1;
 
@@ -253,9 +252,11 @@ static int irq_handler_enable(int irq)
 
         irq_handler_ipc(uirq);
 
-        /* Wake up the interrupt thread directly */
-        thr->priority = SCHED_PRIO_INTR;
+        /* Wake up the interrupt thread directly; it may still be queued
+         * lazily at its old level, so relink through sched_set_priority().
+         */
         thr->state = T_RUNNABLE;
+        sched_set_priority(thr, SCHED_PRIO_INTR);
         sched_enqueue(thr);
     }
 
@@ -281,7 +282,7 @@ void __interrupt_handler(int irq)
 {
     struct user_irq *uirq = user_irq_fetch(irq);
 
-    if (!uirq || uirq->thr_id == L4_NILTHREAD || !uirq->handler ||
+    if (!uirq || !uirq->thr.raw || !uirq->handler ||
         uirq->action != USER_IRQ_ENABLE) {
         return;
     }
@@ -322,7 +323,7 @@ void user_interrupt_config(tcb_t *from)
 
     /* update user irq config */
     if (tid != L4_NILTHREAD)
-        uirq->thr_id = tid;
+        uirq->thr = tcb_handle(thread_by_globalid(tid));
 
     uirq->action = (uint16_t) action;
 
@@ -347,7 +348,7 @@ void user_interrupt_handler_update(tcb_t *thr)
         if (!uirq)
             continue;
 
-        if (uirq->thr_id == thr->t_globalid) {
+        if (tcb_handle_get(uirq->thr) == thr) {
             /* make sure irq is cleared */
             /* clear pending bit */
             user_irq_clear_pending(irq);
@@ -10,6 +10,8 @@
 #include <interrupt.h>
 #include <ipc.h>
 #include <ktimer.h>
+#include <lib/ktable.h>
+#include <lib/string.h>
 #include <memory.h>
 #include <notification.h>
 #include <platform/armv7m.h>
@@ -22,8 +24,7 @@
 extern tcb_t *caller;
 
 /* Imports from thread.c */
-extern tcb_t *thread_map[];
-extern int thread_count;
+extern ktable_t thread_table;
 
 /**
  * Make thread runnable and enqueue to scheduler.
@@ -35,16 +36,6 @@ static inline void thread_make_runnable(tcb_t *thr)
     sched_enqueue(thr);
 }
 
-/* Make sender runnable, restoring base priority.
- * IPC senders should not retain receiver's priority boost.
- */
-static inline void thread_make_sender_runnable(tcb_t *thr)
-{
-    if (thr->priority != thr->base_priority)
-        sched_set_priority(thr, thr->base_priority);
-    thread_make_runnable(thr);
-}
-
 /* Read message register with short buffer support.
  * MR0-MR7:   Hardware registers R4-R11 (ctx.regs[0-7])
  * MR8-MR39:  Short message buffer (msg_buffer[0-31]) - NEW
@@ -74,6 +65,69 @@ void ipc_write_mr(tcb_t *to, int i, uint32_t data)
         to->utcb->mr[i - 40] = data;
 }
 
+/* Sender wait queue.
+ * A send-blocked thread is linked into the ipc_waiters queue of its
+ * receiver, in priority order and FIFO among equal priorities. An open
+ * receive takes the head of its own queue instead of scanning thread_map.
+ */
+static void ipc_wait_enqueue(tcb_t *sender, tcb_t *receiver)
+{
+    tcb_t *prev = NULL, *next = receiver->ipc_waiters;
+
+    /* Lower value is higher priority; skip equal ones to keep FIFO */
+    while (next && next->priority <= sender->priority) {
+        prev = next;
+        next = next->ipc_link.next;
+    }
+
+    sender->ipc_link.prev = prev;
+    sender->ipc_link.next = next;
+    sender->ipc_wait_on = receiver;
+
+    if (prev)
+        prev->ipc_link.next = sender;
+    else
+        receiver->ipc_waiters = sender;
+
+    if (next)
+        next->ipc_link.prev = sender;
+}
+
+/* Sender queued on receiver that matches a receive from from_tid */
+tcb_t *ipc_wait_find(tcb_t *receiver, l4_thread_t from_tid)
+{
+    tcb_t *thr;
+
+    if (from_tid == L4_ANYTHREAD)
+        return receiver->ipc_waiters;
+
+    thr = thread_by_globalid(from_tid);
+    if (thr && thr->ipc_wait_on == receiver)
+        return thr;
+
+    return NULL;
+}
+
+void ipc_wait_dequeue(tcb_t *sender)
+{
+    tcb_t *receiver = sender->ipc_wait_on;
+
+    if (!receiver)
+        return;
+
+    if (sender->ipc_link.prev)
+        sender->ipc_link.prev->ipc_link.next = sender->ipc_link.next;
+    else
+        receiver->ipc_waiters = sender->ipc_link.next;
+
+    if (sender->ipc_link.next)
+        sender->ipc_link.next->ipc_link.prev = sender->ipc_link.prev;
+
+    sender->ipc_link.prev = NULL;
+    sender->ipc_link.next = NULL;
+    sender->ipc_wait_on = NULL;
+}
+
 static void user_ipc_error(tcb_t *thr, enum user_error_t error)
 {
     ipc_msg_tag_t tag;
@@ -95,21 +149,137 @@ static inline void do_ipc_error(tcb_t *from,
 {
     user_ipc_error(from, from_err);
     user_ipc_error(to, to_err);
-    from->state = from_state;
-    to->state = to_state;
+
+    /* Failed partners must be requeued, not just marked runnable */
+    if (from_state == T_RUNNABLE)
+        thread_make_runnable(from);
+    else
+        from->state = from_state;
+    if (to_state == T_RUNNABLE) {
+        /* A failed reply still ends the receiver's Call */
+        thread_sc_return(to);
+        thread_make_runnable(to);
+    } else {
+        to->state = to_state;
+    }
 }
 
+/* Fail all senders queued on receiver, e.g. when it is destroyed */
+void ipc_wait_abort(tcb_t *receiver)
+{
+    while (receiver->ipc_waiters) {
+        tcb_t *sender = receiver->ipc_waiters;
+
+        ipc_wait_dequeue(sender);
+
+        ipc_timeout_cancel(sender);
+        user_ipc_error(sender, UE_IPC_ABORTED | UE_IPC_PHASE_SEND);
+        thread_make_runnable(sender);
+    }
+}
+
+/* StringItem payload copy.
+ * Word-aligned buffers move 32 bytes per LDM/STM pair; the tail and
+ * unaligned buffers fall back to memcpy.
+ */
+static void ipc_string_copy(void *dst, const void *src, size_t len)
+{
+    uint32_t *d = dst;
+    const uint32_t *s = src;
+
+    if ((((uint32_t) d | (uint32_t) s) & 3) == 0) {
+        for (; len >= 32; len -= 32) {
+            __asm__ __volatile__(
+                "ldmia %0!, {r3-r6, r8-r10, r12}\n\t"
+                "stmia %1!, {r3-r6, r8-r10, r12}"
+                : "+r"(s), "+r"(d)
+                :
+                : "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r12",
+                  "memory");
+        }
+    }
+
+    if (len)
+        memcpy(d, s, len);
+}
+
+/* Transfer the idx-th StringItem of a message into the matching receive
+ * buffer of the receiver (BR1..BR7, chained by the C bit).
+ *
+ * Both buffers are checked against the fpages of their address spaces
+ * before the copy. The receiver's MRs are rewritten to describe the
+ * received string: its length and the receive buffer address.
+ *
+ * Returns 0 on success, or the user error to report on both sides.
+ */
+static enum user_error_t ipc_string_xfer(tcb_t *from,
+                                         tcb_t *to,
+                                         int idx,
+                                         ipc_typed_item item,
+                                         memptr_t src,
+                                         int mr)
+{
+    ipc_typed_item rcv = {.raw = 0};
+    memptr_t dst = 0;
+    uint32_t len = item.str.length;
+    int br, n;
+
+    /* Only simple strings: compound strings need a scatter list */
+    if (item.str.j || item.str.c)
+        return UE_IPC_ABORTED;
+
+    if (!to->utcb || !(to->utcb->br[0] & IPC_ACCEPT_STRINGS))
+        return UE_IPC_MSG_OVERFLOW;
+
+    /* Walk to the idx-th receive buffer. Running off the end of the BRs
+     * leaves rcv at the last buffer, which does not belong to idx.
+     */
+    for (br = 1, n = 0; br + 1 < IPC_BR_COUNT; br += 2, ++n) {
+        rcv.raw = to->utcb->br[br];
+        dst = to->utcb->br[br + 1];
+        if (n == idx || !(rcv.s.header & IPC_TI_CONT))
+            break;
+    }
+
+    if (br + 1 >= IPC_BR_COUNT || n != idx || rcv.s.header & IPC_TI_MAP_GRANT ||
+        rcv.str.j || len > rcv.str.length || len > CONFIG_IPC_STRING_MAX)
+        return UE_IPC_MSG_OVERFLOW;
+
+    if (len) {
+        if ((!thread_ispriviliged(from) &&
+             as_check_range(from->as, src, len, MP_USER_PERM(MP_UR)) < 0) ||
+            (!thread_ispriviliged(to) &&
+             as_check_range(to->as, dst, len, MP_USER_PERM(MP_UW)) < 0)) {
+            dbg_printf(DL_IPC, "IPC: REJECT string %p -> %p len %d\n", src,
+                       dst, len);
+            return UE_IPC_ABORTED;
+        }
+
+        ipc_string_copy((void *) dst, (const void *) src, len);
+    }
+
+    dbg_printf(DL_IPC, "IPC: string %d from %t %p to %t %p len %d\n", idx,
+               from->t_globalid, src, to->t_globalid, dst, len);
+
+    item.str.length = len;
+    ipc_write_mr(to, mr - 1, item.raw);
+    ipc_write_mr(to, mr, dst);
+    return 0;
+}
 
 static void do_ipc(tcb_t *from, tcb_t *to)
 {
     ipc_typed_item typed_item;
     int untyped_idx, typed_idx, typed_item_idx;
+    int string_idx = 0;
     uint32_t typed_data; /* typed item extra word */
     l4_thread_t from_recv_tid;
 
-    /* Clear timeout event when ipc is established. */
-    from->timeout_event = 0;
-    to->timeout_event = 0;
+    /* Cancel timeout event when ipc is established. */
+    ipc_timeout_cancel(from);
+    ipc_timeout_cancel(to);
+
+    ipc_wait_dequeue(from);
 
     /* Copy tag of message */
     ipc_msg_tag_t tag = {.raw = ipc_read_mr(from, 0)};
@@ -190,9 +360,20 @@ static void do_ipc(tcb_t *from, tcb_t *to)
                              T_RUNNABLE);
                 return;
             }
-        }
+        } else {
+            /* StringItem: second word is the sender's buffer address */
+            enum user_error_t err;
 
-        /* TODO: StringItem support */
+            err = ipc_string_xfer(from, to, string_idx++, typed_item, mr_data,
+                                  typed_idx);
+            typed_item_idx = -1;
+
+            if (err) {
+                do_ipc_error(from, to, err | UE_IPC_PHASE_SEND,
+                             err | UE_IPC_PHASE_RECV, T_RUNNABLE, T_RUNNABLE);
+                return;
+            }
+        }
     }
 
     if (!to->ctx.sp || !from->ctx.sp) {
@@ -202,17 +383,6 @@ static void do_ipc(tcb_t *from, tcb_t *to)
         return;
     }
 
-    to->utcb->sender = from->t_globalid;
-
-    /* Conditionally boost receiver priority for IPC fast path.
-     * Only boost if receiver was waiting for ANY message (ipc_from ==
-     * ANYTHREAD). If waiting for a specific reply, skip boost - thread was just
-     * processing an IPC and will return to user code immediately after
-     * receiving reply.
-     *
-     * This prevents priority inversion where reply receivers accumulate
-     * priority 3 and starve lower-priority threads indefinitely.
-     */
     /* Write receiver's R0 (sender ID) and UTCB sender BEFORE making runnable.
      * If enqueue happens first and scheduler runs preemptively,
      * receiver could see stale R0 value.
@@ -220,25 +390,24 @@ static void do_ipc(tcb_t *from, tcb_t *to)
     ((uint32_t *) to->ctx.sp)[REG_R0] = from->t_globalid;
     to->utcb->sender = from->t_globalid;
 
-    /* Check ipc_from BEFORE clearing it for priority boost decision */
-    if (to->ipc_from == L4_ANYTHREAD)
-        sched_set_priority(to, SCHED_PRIO_IPC);
+    /* A reply ends the receiver's Call: its scheduling context comes back
+     * and the sender drops to whatever its remaining donors lend it. A
+     * Call (receive phase from the receiver) lends the receiver the
+     * sender's scheduling context until it replies. Both are settled
+     * before the receiver is queued, so it is queued at its final level.
+     */
+    from_recv_tid = ((uint32_t *) from->ctx.sp)[REG_R1];
+    if (to->sc_server)
+        thread_sc_return(to);
+    if (from_recv_tid == to->t_globalid)
+        thread_sc_donate(from, to);
     to->ipc_from = L4_NILTHREAD;
     thread_make_runnable(to);
 
     /* If from has receive phases, lock myself */
-    from_recv_tid = ((uint32_t *) from->ctx.sp)[REG_R1];
     if (from_recv_tid == L4_NILTHREAD) {
-        /* Sender doesn't have receive phase - restore base priority.
-         * This prevents IPC priority boost from accumulating across calls.
-         */
-        thread_make_sender_runnable(from);
+        thread_make_runnable(from);
     } else {
-        /* Sender has receive phase - restore base priority before blocking.
-         * When woken up, receiver will be boosted appropriately.
-         */
-        if (from->priority != from->base_priority)
-            sched_set_priority(from, from->base_priority);
         from->state = T_RECV_BLOCKED;
         from->ipc_from = from_recv_tid;
 
@@ -260,16 +429,16 @@ static void do_ipc(tcb_t *from, tcb_t *to)
      */
     if (to->ipc_notify && to->notify_pending && to->notify_depth < 3) {
         uint32_t basepri;
-        uint8_t generation_before;
+        tcb_handle_t to_handle;
         notify_handler_t callback;
 
-        /* Atomically increment depth and capture generation.
+        /* Atomically increment depth and take a handle on the TCB.
          * BASEPRI masking prevents race with nested interrupt-driven IPC.
          * Zero-latency ISRs (0x0-0x2) can still preempt during this operation.
          */
         basepri = irq_kernel_critical_enter();
         to->notify_depth++;
-        generation_before = to->notify_generation;
+        to_handle = tcb_handle(to);
         callback = to->ipc_notify;
         irq_kernel_critical_exit(basepri);
 
@@ -281,7 +450,7 @@ static void do_ipc(tcb_t *from, tcb_t *to)
         /* Callback executes with interrupts ENABLED to allow
          * nested notifications and prevent priority inversion.
          * TCB LIVENESS: Callback must not destroy its own TCB.
-         * If TCB is destroyed, generation counter will change.
+         * If TCB is destroyed, the handle stops resolving.
          *
          * Pass notify_bits and 0 for notify_data (IPC has no event data).
          */
@@ -289,26 +458,13 @@ static void do_ipc(tcb_t *from, tcb_t *to)
         callback(to, bits, 0);
 
         /* Atomically decrement depth only if TCB still valid.
-         * Generation counter detects TCB destruction during callback.
+         * The handle's generation detects TCB destruction during callback,
+         * even if the slot was reused by a new thread.
          * If TCB was destroyed, skip depth decrement (would be use-after-free).
-         *
-         * SAFETY: We must verify 'to' is still a valid TCB before accessing it.
-         * Search thread_map to confirm the pointer hasn't been freed and
-         * reused.
          */
         basepri = irq_kernel_critical_enter();
 
-        /* Verify TCB is still valid by checking thread_map */
-        int tcb_valid = 0;
-        for (int i = 1; i < thread_count; ++i) {
-            if (thread_map[i] == to) {
-                tcb_valid = 1;
-                break;
-            }
-        }
-
-        /* Only decrement if TCB is valid AND generation hasn't changed */
-        if (tcb_valid && to->notify_generation == generation_before)
+        if (tcb_handle_get(to_handle) == to)
             to->notify_depth--;
 
         irq_kernel_critical_exit(basepri);
@@ -321,42 +477,62 @@ static void do_ipc(tcb_t *from, tcb_t *to)
     }
 }
 
+/* Disarm the thread's IPC timeout, if any */
+void ipc_timeout_cancel(tcb_t *thr)
+{
+    if (thr->timeout_event.data) {
+        ktimer_event_cancel(&thr->timeout_event);
+        thr->timeout_event.data = NULL;
+    }
+}
+
 uint32_t ipc_timeout(void *data)
 {
     ktimer_event_t *event = (ktimer_event_t *) data;
     tcb_t *thr = (tcb_t *) event->data;
 
+    /* Disarmed after it was taken into the current batch */
+    if (!thr)
+        return 0;
+
     dbg_printf(DL_KDB, "IPC: timeout tid=%t st=%d\n", thr->t_globalid,
                thr->state);
 
-    if (thr->timeout_event == (uint32_t) data) {
-        if (thr->state == T_RECV_BLOCKED)
-            user_ipc_error(thr, UE_IPC_TIMEOUT | UE_IPC_PHASE_RECV);
+    event->data = NULL;
 
-        if (thr->state == T_SEND_BLOCKED)
-            user_ipc_error(thr, UE_IPC_TIMEOUT | UE_IPC_PHASE_SEND);
+    if (thr->state == T_RECV_BLOCKED) {
+        user_ipc_error(thr, UE_IPC_TIMEOUT | UE_IPC_PHASE_RECV);
+        thread_sc_return(thr);
+    }
 
-        thread_make_runnable(thr);
-        thr->timeout_event = 0;
+    if (thr->state == T_SEND_BLOCKED) {
+        ipc_wait_dequeue(thr);
+        user_ipc_error(thr, UE_IPC_TIMEOUT | UE_IPC_PHASE_SEND);
     }
 
+    thread_make_runnable(thr);
+
     return 0;
 }
 
 static void sys_ipc_timeout(uint32_t timeout)
 {
-    ktimer_event_t *kevent;
     ipc_time_t t = {.raw = timeout};
 
     /* millisec to ticks */
     uint32_t ticks = (t.period.m << t.period.e) /
                      ((1000000) / (CORE_CLOCK / CONFIG_KTIMER_HEARTBEAT));
 
-    kevent = ktimer_event_create(ticks, ipc_timeout, caller);
+    /* The event lives in the TCB: a timed IPC never allocates, and a stale
+     * timeout from an earlier wait is disarmed rather than left to fire.
+     */
+    ipc_timeout_cancel(caller);
 
-    dbg_printf(DL_KDB, "IPC: sched timeout ticks=%d ev=%p\n", ticks, kevent);
+    if (ktimer_event_arm(&caller->timeout_event, ticks, ipc_timeout,
+                         caller) == -1)
+        caller->timeout_event.data = NULL;
 
-    caller->timeout_event = (uint32_t) kevent;
+    dbg_printf(DL_KDB, "IPC: sched timeout ticks=%d\n", ticks);
 }
 
 void sys_ipc(uint32_t *param1)
@@ -393,6 +569,16 @@ void sys_ipc(uint32_t *param1)
                               to_tid == caller->t_globalid)) {
             /* To thread who is waiting for us or sends to myself */
             do_ipc(caller, to_thr);
+
+            /* Receive phase of Call/ReplyWait: a sender may already be
+             * queued for caller, take it instead of blocking.
+             */
+            if (caller->state == T_RECV_BLOCKED) {
+                tcb_t *thr = ipc_wait_find(caller, caller->ipc_from);
+
+                if (thr)
+                    do_ipc(thr, caller);
+            }
             return;
         } else if (to_thr && to_thr->state == T_INACTIVE && to_thr->utcb &&
                    GLOBALID_TO_TID(to_thr->utcb->t_pager) ==
@@ -565,6 +751,7 @@ void sys_ipc(uint32_t *param1)
                        caller->t_globalid, to_tid, to_thr->state);
             caller->state = T_SEND_BLOCKED;
             caller->utcb->intended_receiver = to_tid;
+            ipc_wait_enqueue(caller, to_thr);
 
             if (timeout)
                 sys_ipc_timeout(timeout);
@@ -576,23 +763,12 @@ void sys_ipc(uint32_t *param1)
     if (from_tid != L4_NILTHREAD) {
         tcb_t *thr = NULL;
 
-        if (from_tid == L4_ANYTHREAD) {
-            /* Find out if there is any sending thread waiting
-             * for caller
-             */
-            for (int i = 1; i < thread_count; ++i) {
-                thr = thread_map[i];
-                if (thr && thr->state == T_SEND_BLOCKED &&
-                    thr->utcb->intended_receiver == caller->t_globalid) {
-                    do_ipc(thr, caller);
-                    return;
-                }
-            }
-        } else if (from_tid != TID_TO_GLOBALID(THREAD_INTERRUPT)) {
-            thr = thread_by_globalid(from_tid);
-
-            if (thr && thr->state == T_SEND_BLOCKED &&
-                thr->utcb->intended_receiver == caller->t_globalid) {
+        /* For an open receive the highest-priority sender waiting for
+         * caller, if any, is the head of its sender queue.
+         */
+        if (from_tid != TID_TO_GLOBALID(THREAD_INTERRUPT)) {
+            thr = ipc_wait_find(caller, from_tid);
+            if (thr) {
                 do_ipc(thr, caller);
                 return;
             }
@@ -603,6 +779,11 @@ void sys_ipc(uint32_t *param1)
         caller->ipc_from = from_tid;
 
         if (from_tid == TID_TO_GLOBALID(THREAD_INTERRUPT)) {
+            /* The SCHED_PRIO_INTR boost from irq_handler_enable() lasts
+             * until the handler waits for its next interrupt.
+             */
+            thread_sc_update(caller);
+
             /* Threaded interrupt is ready */
             user_interrupt_handler_update(caller);
         }
@@ -618,38 +799,23 @@ void sys_ipc(uint32_t *param1)
     caller->state = T_SEND_BLOCKED;
 }
 
+/* Periodic safety net: hand a receiver the sender its queue holds for
+ * it. Only kernel-held state is consulted, never the UTCB, so the queue
+ * order is the delivery order.
+ */
 uint32_t ipc_deliver(void *data)
 {
-    l4_thread_t receiver;
-    tcb_t *from_thr = NULL, *to_thr = NULL;
+    tcb_t *thr, *from_thr;
+    int idx;
 
-    for (int i = 1; i < thread_count; ++i) {
-        tcb_t *thr = thread_map[i];
-        if (!thr)
+    for_each_in_ktable (thr, idx, (&thread_table)) {
+        if (thr->state != T_RECV_BLOCKED || thr->ipc_from == L4_NILTHREAD ||
+            thr->ipc_from == TID_TO_GLOBALID(THREAD_INTERRUPT))
             continue;
-        switch (thr->state) {
-        case T_RECV_BLOCKED:
-            if (thr->ipc_from != L4_NILTHREAD &&
-                thr->ipc_from != L4_ANYTHREAD &&
-                thr->ipc_from != TID_TO_GLOBALID(THREAD_INTERRUPT)) {
-                from_thr = thread_by_globalid(thr->ipc_from);
-                /* NOTE: Must check from_thr intend to send*/
-                if (from_thr && from_thr->state == T_SEND_BLOCKED &&
-                    from_thr->utcb->intended_receiver == thr->t_globalid)
-                    do_ipc(from_thr, thr);
-            }
-            break;
-        case T_SEND_BLOCKED:
-            receiver = thr->utcb->intended_receiver;
-            if (receiver != L4_NILTHREAD && receiver != L4_ANYTHREAD) {
-                to_thr = thread_by_globalid(receiver);
-                if (to_thr && to_thr->state == T_RECV_BLOCKED)
-                    do_ipc(thr, to_thr);
-            }
-            break;
-        default:
-            break;
-        }
+
+        from_thr = ipc_wait_find(thr, thr->ipc_from);
+        if (from_thr && from_thr->state == T_SEND_BLOCKED)
+            do_ipc(from_thr, thr);
     }
 
     return 4096;
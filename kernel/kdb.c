@@ -32,6 +32,11 @@ extern void kdb_show_tickless_verify(void);
 extern void kdb_dump_notifications(void);
 extern void kdb_show_latency(void);
 extern void kdb_reset_latency(void);
+extern void kdb_show_ipc_fastpath(void);
+extern void kdb_show_sched(void);
+extern void kdb_show_cputime(void);
+extern void kdb_show_lathist(void);
+extern void kdb_show_release(void);
 
 struct kdb_t kdb_functions[] = {
     {.option = 'K',
@@ -94,6 +99,32 @@ struct kdb_t kdb_functions[] = {
      .name = "RESET LATENCY",
      .menuentry = "reset latency statistics",
      .function = kdb_reset_latency},
+    {.option = 'f',
+     .name = "IPC FASTPATH",
+     .menuentry = "show IPC fastpath hits",
+     .function = kdb_show_ipc_fastpath},
+    {.option = 'Q',
+     .name = "SCHED QUEUES",
+     .menuentry = "show ready queue statistics",
+     .function = kdb_show_sched},
+#ifdef CONFIG_CPU_ACCOUNTING
+    {.option = 'c',
+     .name = "CPU TOP",
+     .menuentry = "show CPU time per thread",
+     .function = kdb_show_cputime},
+#endif
+#ifdef CONFIG_LATENCY_HISTOGRAM
+    {.option = 'H',
+     .name = "LATENCY HISTOGRAM",
+     .menuentry = "show release and response time per thread",
+     .function = kdb_show_lathist},
+#endif
+#ifdef CONFIG_PERIODIC_RELEASE
+    {.option = 'P',
+     .name = "PERIODIC RELEASE",
+     .menuentry = "show release jitter and missed periods",
+     .function = kdb_show_release},
+#endif
     /* Insert KDB functions here */
 };
 
@@ -0,0 +1,226 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <debug.h>
+#include <kmutex.h>
+#include <l4/utcb.h>
+#include <memory.h>
+#include <platform/armv7m.h>
+#include <sched.h>
+#include <syscall.h>
+#include <thread.h>
+
+#define KMUTEX_ERROR ((uint32_t) -1)
+
+/* A handle records the slot and the generation it was created in, and
+ * fits the 16-bit ceiling_mutex of the UTCB. Generation 0 is never issued,
+ * so 0 means no mutex, and a handle kept past KMUTEX_DESTROY no longer
+ * resolves once the slot is reused.
+ */
+typedef union {
+    struct {
+        uint8_t index;
+        uint8_t gen;
+    } s;
+    uint16_t raw;
+} kmutex_handle_t;
+
+typedef struct {
+    uint8_t ceiling;      /* L4 priority, 0 while the slot is free */
+    uint8_t gen;          /* bumped by each KMUTEX_CREATE of the slot */
+    tcb_handle_t creator; /* the only thread allowed to destroy it */
+    tcb_t *waiters;       /* T_MUTEX_BLOCKED threads, by priority, then FIFO */
+} kmutex_t;
+
+static kmutex_t kmutex_table[CONFIG_KMUTEX_MAX];
+
+static kmutex_t *kmutex_get(uint32_t handle)
+{
+    kmutex_handle_t h = {.raw = (uint16_t) handle};
+
+    if (handle > 0xFFFF || h.s.gen == 0 || h.s.index >= CONFIG_KMUTEX_MAX ||
+        h.s.gen != kmutex_table[h.s.index].gen ||
+        !kmutex_table[h.s.index].ceiling)
+        return NULL;
+    return &kmutex_table[h.s.index];
+}
+
+/* Hold thr at the ceiling of the mutex its UTCB names, or at its own
+ * level when that is higher. A raise that no longer matches the mutex
+ * named goes back to the donated or base priority first.
+ */
+static void kmutex_apply(tcb_t *thr)
+{
+    kmutex_t *m = thr->utcb ? kmutex_get(thr->utcb->ceiling_mutex) : NULL;
+
+    if (thr->kmutex_raised && (!m || m->ceiling != thr->priority)) {
+        thr->kmutex_raised = 0;
+        thread_sc_update(thr);
+    }
+
+    if (m && m->ceiling < thr->priority) {
+        sched_set_priority(thr, m->ceiling);
+        thr->kmutex_raised = 1;
+
+        /* A Call already in flight lends the ceiling to its server too */
+        if (thr->sc_server)
+            thread_sc_update(thr->sc_server);
+    }
+
+    if (thr->utcb)
+        thr->utcb->ceiling_raised = thr->kmutex_raised;
+}
+
+/* Called by schedule_select() before it picks: an owner that is about to
+ * be weighed against another thread first goes up to its ceiling. This
+ * includes an owner that has just blocked, so that it is already at the
+ * ceiling when it is woken.
+ */
+void kmutex_schedule(tcb_t *curr)
+{
+    if (curr && curr->state != T_INACTIVE &&
+        (curr->kmutex_raised || (curr->utcb && curr->utcb->ceiling_mutex)))
+        kmutex_apply(curr);
+}
+
+static void kmutex_enqueue(kmutex_t *m, tcb_t *thr)
+{
+    tcb_t **link = &m->waiters;
+
+    while (*link && (*link)->priority <= thr->priority)
+        link = &(*link)->kmutex_next;
+
+    thr->kmutex_next = *link;
+    *link = thr;
+}
+
+static void kmutex_dequeue(kmutex_t *m, tcb_t *thr)
+{
+    tcb_t **link = &m->waiters;
+
+    while (*link && *link != thr)
+        link = &(*link)->kmutex_next;
+
+    if (*link)
+        *link = thr->kmutex_next;
+    thr->kmutex_next = NULL;
+    thr->kmutex_wait = 0;
+}
+
+void kmutex_thread_exit(tcb_t *thr)
+{
+    kmutex_t *m = kmutex_get(thr->kmutex_wait);
+
+    if (m)
+        kmutex_dequeue(m, thr);
+    thr->kmutex_raised = 0;
+}
+
+static uint32_t kmutex_create(tcb_t *caller, uint32_t ceiling)
+{
+    kmutex_handle_t h;
+    int i;
+
+    if (ceiling < SCHED_PRIO_NORMAL_MIN || ceiling > SCHED_PRIO_NORMAL_MAX)
+        return 0;
+
+    for (i = 0; i < CONFIG_KMUTEX_MAX; ++i) {
+        kmutex_t *m = &kmutex_table[i];
+
+        if (!m->ceiling) {
+            if (++m->gen == 0)
+                m->gen = 1;
+            m->ceiling = ceiling;
+            m->creator = tcb_handle(caller);
+            m->waiters = NULL;
+
+            h.s.index = i;
+            h.s.gen = m->gen;
+            return h.raw;
+        }
+    }
+
+    dbg_printf(DL_SYSCALL, "KMUTEX: table full\n");
+    return 0;
+}
+
+/* Sleep while the lock word still reads contended. The caller set it
+ * after its own acquire failed; any unlock since then reset it, so the
+ * check closes the window between the two.
+ */
+static uint32_t kmutex_wait(tcb_t *caller, uint32_t handle, memptr_t word)
+{
+    kmutex_t *m = kmutex_get(handle);
+
+    if (!m || (word & 3) ||
+        as_check_range(caller->as, word, sizeof(uint32_t),
+                       MP_USER_PERM(MP_UR)) < 0)
+        return KMUTEX_ERROR;
+
+    /* Above the ceiling: the protocol cannot bound this thread's wait */
+    if (caller->base_priority < m->ceiling)
+        return KMUTEX_ERROR;
+
+    if (*(volatile uint32_t *) word != KMUTEX_CONTENDED)
+        return 0;
+
+    caller->kmutex_wait = handle;
+    kmutex_enqueue(m, caller);
+    caller->state = T_MUTEX_BLOCKED;
+    return 0;
+}
+
+static uint32_t kmutex_wake(tcb_t *caller, uint32_t handle)
+{
+    kmutex_t *m = kmutex_get(handle);
+    tcb_t *waiter;
+
+    /* The unlock already cleared or replaced ceiling_mutex */
+    kmutex_apply(caller);
+
+    if (!m)
+        return KMUTEX_ERROR;
+
+    waiter = m->waiters;
+    if (waiter) {
+        kmutex_dequeue(m, waiter);
+        waiter->state = T_RUNNABLE;
+        sched_enqueue(waiter);
+    }
+    return 0;
+}
+
+void kmutex_syscall(tcb_t *caller, uint32_t *param)
+{
+    uint32_t handle = param[REG_R1];
+    uint32_t ret = KMUTEX_ERROR;
+    kmutex_t *m;
+
+    switch ((kmutex_op_t) param[REG_R0]) {
+    case KMUTEX_CREATE:
+        ret = kmutex_create(caller, handle);
+        break;
+    case KMUTEX_DESTROY:
+        m = kmutex_get(handle);
+        if (m && !m->waiters && tcb_handle_get(m->creator) == caller) {
+            m->ceiling = 0;
+            ret = 0;
+        }
+        break;
+    case KMUTEX_WAIT:
+        ret = kmutex_wait(caller, handle, param[REG_R2]);
+        break;
+    case KMUTEX_WAKE:
+        ret = kmutex_wake(caller, handle);
+        break;
+    }
+
+    param[REG_R0] = ret;
+
+    if (caller->state != T_MUTEX_BLOCKED) {
+        caller->state = T_RUNNABLE;
+        sched_enqueue(caller);
+    }
+}
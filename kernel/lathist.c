@@ -0,0 +1,137 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <cputime.h>
+#include <debug.h>
+#include <lathist.h>
+#include <memory.h>
+#include <platform/irq.h>
+#include <thread.h>
+#include INC_PLAT(systick.h)
+
+extern tcb_t *kernel;
+
+#define LATHIST_CYCLES_PER_US (CORE_CLOCK / 1000000)
+
+/* lat_flags */
+#define LATHIST_RELEASED 0x1   /* lat_release is pending */
+#define LATHIST_DISPATCHED 0x2 /* lat_dispatch is pending */
+
+/* Thread last switched out other than the kernel thread. Whether it
+ * blocked is only known once the kernel thread is done with its syscall.
+ */
+static tcb_t *lathist_watch;
+
+static void lathist_record(tcb_t *thr, lathist_t kind, uint32_t cycles)
+{
+    uint32_t us = cycles / LATHIST_CYCLES_PER_US;
+    int b = us ? 32 - __builtin_clz(us) : 0;
+
+    if (b >= LATHIST_BUCKETS)
+        b = LATHIST_BUCKETS - 1;
+    if (thr->lat_hist[kind][b] != 0xFFFF)
+        ++thr->lat_hist[kind][b];
+}
+
+/* thr has blocked: close the interval since its dispatch */
+static void lathist_block(tcb_t *thr)
+{
+    if (!(thr->lat_flags & LATHIST_DISPATCHED))
+        return;
+
+    lathist_record(thr, LATHIST_RESPONSE, thr->lat_stop - thr->lat_dispatch);
+    thr->lat_flags &= ~LATHIST_DISPATCHED;
+}
+
+/* Called by notify_wake_thread() when a notification wakes thr */
+void lathist_release(tcb_t *thr)
+{
+    uint32_t basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+
+    /* Woken from a wait, so it blocked, perhaps without a switch since */
+    lathist_block(thr);
+
+    if (!(thr->lat_flags & LATHIST_RELEASED)) {
+        thr->lat_release = cputime_cycles();
+        thr->lat_flags |= LATHIST_RELEASED;
+    }
+    irq_restore_basepri(basepri);
+}
+
+/* Called by thread_switch() */
+void lathist_switch(tcb_t *prev, tcb_t *next)
+{
+    uint32_t basepri = irq_save_basepri(IRQ_PRIO_SYSTICK);
+    uint32_t now = cputime_cycles();
+    tcb_t *watch;
+
+    if (prev && prev != kernel) {
+        prev->lat_stop = now;
+        lathist_watch = prev;
+    }
+
+    if (next == kernel) {
+        irq_restore_basepri(basepri);
+        return;
+    }
+
+    /* Leaving the kernel thread or a user thread: syscalls are done */
+    watch = lathist_watch;
+    lathist_watch = NULL;
+    if (watch && watch != next && watch->state != T_RUNNABLE &&
+        watch->state != T_SVC_BLOCKED)
+        lathist_block(watch);
+
+    if (next->lat_flags & LATHIST_RELEASED) {
+        lathist_record(next, LATHIST_RELEASE, now - next->lat_release);
+        next->lat_dispatch = now;
+        next->lat_flags =
+            (next->lat_flags & ~LATHIST_RELEASED) | LATHIST_DISPATCHED;
+    }
+    irq_restore_basepri(basepri);
+}
+
+void lathist_thread_exit(tcb_t *thr)
+{
+    if (lathist_watch == thr)
+        lathist_watch = NULL;
+}
+
+/**
+ * SYS_LATENCY: copy a histogram to user memory.
+ *
+ *   R0: thread, L4_NILTHREAD for the caller
+ *   R1: lathist_t, optionally with LATHIST_RESET
+ *   R2: buffer of LATHIST_BUCKETS uint16_t
+ *
+ * Returns (R0) LATHIST_BUCKETS, or 0 on a bad thread, kind or buffer.
+ */
+void lathist_syscall(tcb_t *caller, uint32_t *param)
+{
+    l4_thread_t tid = param[REG_R0];
+    uint32_t kind = param[REG_R1] & ~LATHIST_RESET;
+    memptr_t buf = param[REG_R2];
+    tcb_t *thr = tid ? thread_by_globalid(tid) : caller;
+    uint16_t *out = (uint16_t *) buf;
+
+    param[REG_R0] = 0;
+
+    /* Only the histograms of the caller's own address space may be reset */
+    if ((param[REG_R1] & LATHIST_RESET) && thr && thr->as != caller->as)
+        return;
+
+    if (!thr || kind >= LATHIST_KINDS || (buf & 1) ||
+        as_check_range(caller->as, buf, sizeof(thr->lat_hist[kind]),
+                       MP_USER_PERM(MP_UW)) < 0)
+        return;
+
+    for (int b = 0; b < LATHIST_BUCKETS; ++b) {
+        out[b] = thr->lat_hist[kind][b];
+        if (param[REG_R1] & LATHIST_RESET)
+            thr->lat_hist[kind][b] = 0;
+    }
+
+    param[REG_R0] = LATHIST_BUCKETS;
+}
@@ -537,6 +537,36 @@ void as_destroy(as_t *as)
     ktable_free(&as_table, (void *) as);
 }
 
+int as_check_range(as_t *as, memptr_t base, size_t size, uint32_t rwx)
+{
+    memptr_t probe = base, end;
+    fpage_t *fp;
+
+    if (!as || size == 0 || base > (memptr_t) -1 - size + 1)
+        return -1;
+
+    end = base + size;
+
+    /* Fpage chain is not sorted: look up the fpage holding each
+     * unchecked address in turn, so holes and gaps are caught.
+     */
+    while (probe < end) {
+        for (fp = as->first; fp; fp = fp->as_next) {
+            if (addr_in_fpage(probe, fp, 0))
+                break;
+        }
+
+        if (!fp || (fp->fpage.rwx & rwx) != rwx)
+            return -1;
+
+        if (FPAGE_END(fp) == 0) /* fpage ends at top of address space */
+            break;
+        probe = FPAGE_END(fp);
+    }
+
+    return 0;
+}
+
 int map_area(as_t *src,
              as_t *dst,
              memptr_t base,
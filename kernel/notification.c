@@ -5,10 +5,12 @@
 
 #include <debug.h>
 #include <init_hook.h>
+#include <lathist.h>
 #include <lib/ktable.h>
 #include <notification.h>
 #include <platform/armv7m.h>
 #include <platform/irq.h>
+#include <release.h>
 #include <sched.h>
 #include <softirq.h>
 #include <thread.h>
@@ -151,12 +153,11 @@ uint32_t notification_read_clear(tcb_t *tcb, uint32_t mask)
 /* Asynchronous notifications (queue-based delivery) */
 
 /* Async event structure
- * Uses thread ID (not raw pointer) for safe cross-reference - prevents
+ * Uses a TCB handle (not raw pointer) for safe cross-reference - prevents
  * use-after-free if thread destroyed while event queued.
  */
 typedef struct async_event {
-    l4_thread_t
-        target_id; /* Thread global ID (safe lookup via thread_by_globalid) */
+    tcb_handle_t target;      /* Target thread (resolved via tcb_handle_get) */
     uint32_t notify_bits;     /* Notification bit mask */
     uint32_t event_data;      /* Optional 32-bit payload */
     struct async_event *next; /* Queue linkage */
@@ -230,7 +231,7 @@ int notify_wake_thread(tcb_t *thr)
 
     /* Check if any signaled bits match the thread's wait mask */
     uint32_t matched = thr->notify_bits & thr->notify_mask;
-    if (!matched) {
+    if (!matched || release_spurious(thr)) {
         irq_restore_flags(flags);
         return 0;
     }
@@ -246,6 +247,7 @@ int notify_wake_thread(tcb_t *thr)
     /* Clear mask and wake thread - must be inside critical section */
     thr->notify_mask = 0;
     thr->state = T_RUNNABLE;
+    lathist_release(thr);
     sched_enqueue(thr);
 
     irq_restore_flags(flags);
@@ -342,7 +344,7 @@ int notification_post(tcb_t *thr, uint32_t notify_bits, uint32_t event_data)
     }
 
     /* Initialize event */
-    event->target_id = thr->t_globalid;
+    event->target = tcb_handle(thr);
     event->notify_bits = notify_bits;
     event->event_data = event_data;
     event->next = NULL;
@@ -412,15 +414,15 @@ static void notification_async_handler(void)
 
         /* Deliver notification to target thread.
          * Event-Chaining callback will execute when thread next runs.
-         * Lookup thread by ID to handle case where thread was destroyed
+         * Resolve the handle to handle case where thread was destroyed
          * while event was queued (prevents use-after-free).
          */
-        tcb_t *thr = thread_by_globalid(event->target_id);
+        tcb_t *thr = tcb_handle_get(event->target);
         if (!thr) {
             /* Thread destroyed before delivery - drop event safely */
             dbg_printf(DL_NOTIFICATIONS,
-                       "ASYNC: Dropping event for dead thread %t\n",
-                       event->target_id);
+                       "ASYNC: Dropping event for dead thread slot %d\n",
+                       event->target.s.index);
             ktable_free(&notification_async_table, event);
             notification_async_queue_count--;
             continue;
@@ -909,8 +911,11 @@ void kdb_dump_notifications(void)
         int idx = 0;
 
         while (event && idx < KDB_MAX_PENDING_DISPLAY) {
+            tcb_t *target = tcb_handle_get(event->target);
+
             dbg_printf(DL_KDB, "  [%d] target=%t bits=0x%x data=0x%x\n", idx,
-                       event->target_id, event->notify_bits, event->event_data);
+                       target ? target->t_globalid : L4_NILTHREAD,
+                       event->notify_bits, event->event_data);
             event = event->next;
             idx++;
         }
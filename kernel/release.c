@@ -0,0 +1,186 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <debug.h>
+#include <ktimer.h>
+#include <notification.h>
+#include <platform/irq.h>
+#include <release.h>
+#include <sched.h>
+#include <syscall.h>
+#include <thread.h>
+
+/* Hand the pending releases to a waiter: returns the periods missed */
+static uint32_t release_consume(tcb_t *thr)
+{
+    uint32_t missed = thr->rel_pending - 1;
+
+    thr->rel_missed += missed;
+    thr->rel_pending = 0;
+    thr->rel_waiting = 0;
+    notification_clear(thr, RELEASE_NOTIFY_BIT);
+    return missed;
+}
+
+/* Release event (ktimer callback, softirq context) */
+static uint32_t release_handler(void *data)
+{
+    ktimer_event_t *event = (ktimer_event_t *) data;
+    tcb_t *thr = (tcb_t *) event->data;
+    uint64_t now = ktimer_get_now();
+    int32_t jitter;
+
+    if (!thr)
+        return 0;
+
+    /* Chained with an earlier batch, the event may even fire early */
+    jitter = (int32_t) (now - event->deadline);
+    thr->rel_jitter = (jitter < 0) ? -jitter : jitter;
+    if (thr->rel_jitter > thr->rel_jitter_max)
+        thr->rel_jitter_max = thr->rel_jitter;
+    ++thr->rel_count;
+
+    if (thr->rel_pending != 0xFFFF)
+        ++thr->rel_pending;
+
+    notification_signal(thr, RELEASE_NOTIFY_BIT);
+    if (thr->rel_waiting && notify_wake_thread(thr))
+        ((uint32_t *) thr->ctx.sp)[REG_R0] = release_consume(thr);
+
+    if (!thr->rel_period) {
+        event->data = NULL;
+        return 0;
+    }
+
+    /* Measure the next release from this one rather than from now, so a
+     * late callback doesn't drift the period. Behind schedule, each tick
+     * releases one missed period until the releases catch up.
+     */
+    event->deadline += thr->rel_period;
+    return (event->deadline > now) ? (uint32_t) (event->deadline - now) : 1;
+}
+
+static void release_stop(tcb_t *thr)
+{
+    if (thr->rel_event.data) {
+        ktimer_event_cancel(&thr->rel_event);
+        thr->rel_event.data = NULL;
+    }
+    thr->rel_pending = 0;
+    notification_clear(thr, RELEASE_NOTIFY_BIT);
+}
+
+/* Whether thr's RELEASE_NOTIFY_BIT already belongs to something else:
+ * the EDF band, time-triggered windows, or periodic releases it must
+ * stop first so that a one-shot release cannot cancel them.
+ */
+static int release_busy(tcb_t *thr)
+{
+#ifdef CONFIG_SCHED_EDF
+    if (thr->edf_period)
+        return 1;
+#endif
+#ifdef CONFIG_SCHED_TT
+    if (thr->tt_windows)
+        return 1;
+#endif
+    return thr->rel_event.data && thr->rel_period;
+}
+
+static int release_set(tcb_t *thr, uint64_t first, uint32_t period)
+{
+    uint64_t now = ktimer_get_now();
+
+    if (release_busy(thr))
+        return -1;
+
+    release_stop(thr);
+
+    if (!first)
+        first = now + period;
+    if (!period && first <= now)
+        return -1;
+    if (first > now && first - now > 0xFFFFFFFF)
+        return -1;
+
+    thr->rel_period = period;
+
+    if (ktimer_event_arm(&thr->rel_event,
+                         (first > now) ? (uint32_t) (first - now) : 1,
+                         release_handler, thr) < 0) {
+        thr->rel_event.data = NULL;
+        return -1;
+    }
+
+    /* Only ktimer_notify_handler() reads deadline, so it's ours to use */
+    thr->rel_event.deadline = first;
+    return 0;
+}
+
+/**
+ * SYS_RELEASE: absolute periodic releases of the caller.
+ *
+ *   R0: release_op_t
+ *   R1/R2: RELEASE_SET first release, absolute ticks; 0 for one period
+ *          from now
+ *   R3: RELEASE_SET period in ticks, 0 for a single release
+ *
+ * Returns (R0) 0 on success, or for RELEASE_WAIT the periods missed;
+ * ~0 on bad parameters, on a wait with no release armed, or on a
+ * RELEASE_SET by an EDF or time-triggered thread or one whose periodic
+ * releases are still armed.
+ */
+void release_syscall(tcb_t *caller, uint32_t *param)
+{
+    uint32_t flags;
+
+    switch (param[REG_R0]) {
+    case RELEASE_SET:
+        param[REG_R0] = release_set(caller,
+                                    ((uint64_t) param[REG_R2] << 32) |
+                                        param[REG_R1],
+                                    param[REG_R3]);
+        break;
+    case RELEASE_STOP:
+        release_stop(caller);
+        param[REG_R0] = 0;
+        break;
+    case RELEASE_WAIT:
+        flags = irq_save_flags();
+        if (caller->rel_pending) {
+            param[REG_R0] = release_consume(caller);
+        } else if (caller->rel_event.data) {
+            /* Woken by release_handler(), which sets R0 */
+            caller->rel_waiting = 1;
+            caller->notify_mask = RELEASE_NOTIFY_BIT;
+            caller->state = T_NOTIFY_BLOCKED;
+            irq_restore_flags(flags);
+            return;
+        } else {
+            param[REG_R0] = ~0;
+        }
+        irq_restore_flags(flags);
+        break;
+    default:
+        param[REG_R0] = ~0;
+        break;
+    }
+
+    caller->state = T_RUNNABLE;
+    sched_enqueue(caller);
+}
+
+void release_thread_exit(tcb_t *thr)
+{
+    release_stop(thr);
+}
+
+/* Whether waking thr now would be a RELEASE_WAIT without a release: bit 31
+ * posted by someone other than release_handler(). The wait goes on.
+ */
+int release_spurious(tcb_t *thr)
+{
+    return thr->rel_waiting && !thr->rel_pending;
+}
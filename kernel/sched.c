@@ -6,9 +6,15 @@
 #include <debug.h>
 #include <error.h>
 #include <init_hook.h>
+#include <kmutex.h>
+#include <ktimer.h>
+#include <notification.h>
 #include <platform/irq.h>
 #include <sched.h>
+#include <syscall.h>
 #include <thread.h>
+#include <tt.h>
+#include <upcall.h>
 
 /**
  * @file sched.c
@@ -18,7 +24,9 @@
  * Uses Cortex-M CLZ instruction for efficient bitmap scanning.
  *
  * Performance optimizations:
- *   - Strict queue invariant: only runnable threads in ready queues
+ *   - Lazy queueing: a thread that blocks may stay in its ready queue;
+ *     schedule_select() drops it once it reaches the queue head, and
+ *     waking it again before that costs nothing
  *   - Conditional bitmap updates: only write when queue state changes
  *   - Branch-free CLZ: __builtin_clz returns 32 for 0, no check needed
  *   - Zero-offset sched_link: first field in TCB for fast pointer math
@@ -28,20 +36,62 @@
  *   - ready_bitmap: One bit per priority level (bit 31 = prio 0,
  *     bit 0 = prio 31)
  *   - ready_queue[]: Circular doubly-linked list per priority level
+ *
+ * With CONFIG_SCHED_PRIO_256 the bitmap has two levels: one 32-bit word
+ * per group of 32 priorities, and a summary word with one bit per
+ * non-empty group. Selection is two CLZs instead of one.
+ *
+ * EDF band (CONFIG_SCHED_EDF): the SCHED_PRIO_EDF queue is kept sorted
+ * by absolute deadline instead of FIFO, so its head is the earliest
+ * deadline. Within the band a thread preempts a later-deadline one; to
+ * every other level the band is an ordinary priority.
  */
 
+/* One bit per priority level, MSB first within each word */
+typedef struct {
+#ifdef CONFIG_SCHED_PRIO_256
+    uint32_t summary; /* bit (31 - g) set: group[g] is non-zero */
+#endif
+    uint32_t group[SCHED_PRIORITY_LEVELS / 32];
+} prio_bitmap_t;
+
 /* Priority bitmap: bit set means queue has runnable threads */
-static uint32_t ready_bitmap;
+static prio_bitmap_t ready_bitmap;
 
 /* Preempted bitmap: tracks priorities deferred by preemption-threshold.
  * Bit set means a thread at that priority was ready but couldn't preempt
  * the running thread due to its preemption threshold.
  */
-static uint32_t preempted_bitmap;
+static prio_bitmap_t preempted_bitmap;
 
 /* Ready queue heads for each priority level (circular doubly-linked) */
 static tcb_t *ready_queue[SCHED_PRIORITY_LEVELS];
 
+#ifdef CONFIG_SCHED_RR
+/* Thread whose quantum expired, set by sched_tick() from SysTick. SysTick
+ * is above the kernel critical section mask, so it never touches the
+ * queues itself; schedule_select() rotates.
+ */
+static tcb_t *volatile sched_quantum_expired;
+#endif
+
+#ifdef CONFIG_KDB
+/* Queue work statistics, shown by KDB */
+static struct {
+    uint32_t crit;     /* critical sections entered by queue operations */
+    uint32_t enqueue;  /* threads linked into a ready queue */
+    uint32_t dequeue;  /* threads unlinked from a ready queue */
+    uint32_t lazy_hit; /* wakeups of threads still queued */
+    uint32_t lazy_drop; /* blocked threads dropped at the queue head */
+    uint32_t rotate;    /* round-robin quantum expiries acted on */
+} sched_stats;
+#define SCHED_STAT(x) (sched_stats.x++)
+#else
+#define SCHED_STAT(x) \
+    do {              \
+    } while (0)
+#endif
+
 /**
  * Count leading zeros using Cortex-M CLZ instruction.
  * Returns 32 if input is 0.
@@ -56,13 +106,46 @@ static inline uint32_t clz32(uint32_t x)
     return result;
 }
 
+static inline void prio_bitmap_set(prio_bitmap_t *map, uint32_t prio)
+{
+    map->group[prio >> 5] |= 1UL << (31 - (prio & 31));
+#ifdef CONFIG_SCHED_PRIO_256
+    map->summary |= 1UL << (31 - (prio >> 5));
+#endif
+}
+
+static inline void prio_bitmap_clear(prio_bitmap_t *map, uint32_t prio)
+{
+    map->group[prio >> 5] &= ~(1UL << (31 - (prio & 31)));
+#ifdef CONFIG_SCHED_PRIO_256
+    if (!map->group[prio >> 5])
+        map->summary &= ~(1UL << (31 - (prio >> 5)));
+#endif
+}
+
+/* Highest priority with its bit set, SCHED_PRIORITY_LEVELS if none */
+static inline uint32_t prio_bitmap_first(prio_bitmap_t *map)
+{
+#ifdef CONFIG_SCHED_PRIO_256
+    uint32_t g = clz32(map->summary);
+
+    if (g >= SCHED_PRIORITY_LEVELS / 32)
+        return SCHED_PRIORITY_LEVELS;
+
+    return (g << 5) + clz32(map->group[g]);
+#else
+    /* CLZ returns 32 if bitmap is 0 (no branches needed) */
+    return clz32(map->group[0]);
+#endif
+}
+
 /**
  * Initialize scheduler.
  */
 void sched_init(void)
 {
-    ready_bitmap = 0;
-    preempted_bitmap = 0;
+    ready_bitmap = (prio_bitmap_t){0};
+    preempted_bitmap = (prio_bitmap_t){0};
 
     for (int i = 0; i < SCHED_PRIORITY_LEVELS; ++i)
         ready_queue[i] = NULL;
@@ -89,9 +172,30 @@ static inline void sched_link_init(tcb_t *thread)
     thread->sched_link.next = NULL;
 }
 
+#ifdef CONFIG_SCHED_EDF
+/**
+ * Position for thread in the EDF queue: the first thread with a later
+ * deadline, or head (i.e. the tail) if there is none. Equal deadlines
+ * stay FIFO.
+ */
+static tcb_t *sched_edf_successor(tcb_t *head, tcb_t *thread)
+{
+    tcb_t *pos = head;
+
+    do {
+        if (pos->edf_deadline > thread->edf_deadline)
+            return pos;
+        pos = pos->sched_link.next;
+    } while (pos != head);
+
+    return head;
+}
+#endif
+
 /**
  * Enqueue thread to ready queue at its priority level.
- * Adds to tail for FIFO ordering within priority.
+ * Adds to tail for FIFO ordering within priority; the EDF band inserts
+ * in deadline order instead.
  *
  * Optimization: Only updates bitmap when queue was empty.
  * IRQ-safe: protects critical section from interrupt corruption.
@@ -105,17 +209,27 @@ void sched_enqueue(tcb_t *thread)
     if (!thread)
         return;
 
-    basepri = irq_kernel_critical_enter();
-
-    /* Strict invariant: only runnable threads in ready queues
-     * Check inside critical section to prevent race with state changes
-     */
-    if (thread->state != T_RUNNABLE) {
-        irq_kernel_critical_exit(basepri);
+    if (thread->state != T_RUNNABLE)
         panic("SCHED: Enqueueing non-runnable thread %t (state %d)\n",
               thread->t_globalid, thread->state);
+
+    /* Lazy queueing: a thread woken before schedule_select() dropped it
+     * is still in place. State is already T_RUNNABLE, so nothing can
+     * unlink it behind our back and no critical section is needed.
+     */
+    __asm__ __volatile__("" ::: "memory");
+    if (sched_is_queued(thread)) {
+        SCHED_STAT(lazy_hit);
+        return;
     }
 
+    /* A time-triggered thread only queues while its window is open */
+    if (tt_parked(thread))
+        return;
+
+    basepri = irq_kernel_critical_enter();
+    SCHED_STAT(crit);
+
     /* Don't double-enqueue */
     if (sched_is_queued(thread)) {
         irq_kernel_critical_exit(basepri);
@@ -135,42 +249,39 @@ void sched_enqueue(tcb_t *thread)
         thread->sched_link.next = thread;
 
         /* Optimization: Only set bitmap when queue was empty */
-        ready_bitmap |= (1UL << (31 - prio));
+        prio_bitmap_set(&ready_bitmap, prio);
     } else {
         /* Insert at tail (before head in circular list) */
-        tcb_t *tail = head->sched_link.prev;
+        tcb_t *pos = head, *tail;
 
-        thread->sched_link.next = head;
+#ifdef CONFIG_SCHED_EDF
+        if (prio == SCHED_PRIO_EDF) {
+            pos = sched_edf_successor(head, thread);
+            if (pos == head && head->edf_deadline > thread->edf_deadline)
+                ready_queue[prio] = thread;
+        }
+#endif
+
+        tail = pos->sched_link.prev;
+        thread->sched_link.next = pos;
         thread->sched_link.prev = tail;
         tail->sched_link.next = thread;
-        head->sched_link.prev = thread;
+        pos->sched_link.prev = thread;
         /* Bitmap already set - no update needed */
     }
+    SCHED_STAT(enqueue);
 
     irq_kernel_critical_exit(basepri);
 }
 
 /**
- * Dequeue thread from ready queue.
- * Must be called before thread enters blocked state.
- * IRQ-safe: protects critical section from interrupt corruption.
+ * Unlink a queued thread from its ready queue.
+ * Caller must hold the kernel critical section.
  */
-void sched_dequeue(tcb_t *thread)
+static void sched_unlink(tcb_t *thread)
 {
     uint8_t prio;
     tcb_t *prev, *next;
-    uint32_t basepri;
-
-    if (!thread)
-        return;
-
-    basepri = irq_kernel_critical_enter();
-
-    /* Not in queue */
-    if (!sched_is_queued(thread)) {
-        irq_kernel_critical_exit(basepri);
-        return;
-    }
 
     prio = thread->priority;
     if (prio >= SCHED_PRIORITY_LEVELS)
@@ -182,7 +293,7 @@ void sched_dequeue(tcb_t *thread)
     if (thread == next) {
         /* Only element in queue */
         ready_queue[prio] = NULL;
-        ready_bitmap &= ~(1UL << (31 - prio));
+        prio_bitmap_clear(&ready_bitmap, prio);
     } else {
         /* Unlink from list */
         prev->sched_link.next = next;
@@ -196,63 +307,259 @@ void sched_dequeue(tcb_t *thread)
 
     /* Mark as not queued */
     sched_link_init(thread);
-
-    irq_kernel_critical_exit(basepri);
+    SCHED_STAT(dequeue);
 }
 
 /**
- * Yield current thread's timeslice.
- * Rotates thread to back of its priority queue for round-robin.
+ * Dequeue thread from ready queue.
+ * With lazy queueing this is only required when the TCB goes away or
+ * changes queue; a thread that merely blocks can stay queued.
  * IRQ-safe: protects critical section from interrupt corruption.
  */
-void sched_yield(void)
+void sched_dequeue(tcb_t *thread)
 {
-    tcb_t *curr = thread_current();
-    uint8_t prio;
-    tcb_t *head;
     uint32_t basepri;
 
-    if (!curr)
+    if (!thread)
         return;
 
     basepri = irq_kernel_critical_enter();
+    SCHED_STAT(crit);
 
-    if (!sched_is_queued(curr)) {
-        irq_kernel_critical_exit(basepri);
-        return;
+    if (sched_is_queued(thread))
+        sched_unlink(thread);
+
+    irq_kernel_critical_exit(basepri);
+}
+
+/**
+ * Highest-priority runnable thread, or NULL if none is queued.
+ * Blocked threads left queued by lazy queueing are dropped as they
+ * reach the head, so each one is unlinked at most once.
+ * Caller must hold the kernel critical section.
+ */
+static tcb_t *sched_pick(uint32_t *prio)
+{
+    tcb_t *thread;
+
+    for (;;) {
+        *prio = prio_bitmap_first(&ready_bitmap);
+        if (*prio >= SCHED_PRIORITY_LEVELS)
+            return NULL;
+
+        thread = ready_queue[*prio];
+        if (!thread || thread->state == T_RUNNABLE)
+            return thread;
+
+        sched_unlink(thread);
+        SCHED_STAT(lazy_drop);
     }
+}
+
+/**
+ * Rotate thread's level so that the thread after its head comes first.
+ * Not within the EDF band, whose order is by deadline.
+ * Caller must hold the kernel critical section.
+ */
+static void sched_rotate(tcb_t *thread)
+{
+    uint8_t prio;
+    tcb_t *head;
+
+    if (!sched_is_queued(thread))
+        return;
 
-    prio = curr->priority;
+    prio = thread->priority;
     if (prio >= SCHED_PRIORITY_LEVELS)
         prio = SCHED_PRIO_IDLE;
 
+#ifdef CONFIG_SCHED_EDF
+    /* Deadline order is the policy in the EDF band: never rotate */
+    if (prio == SCHED_PRIO_EDF)
+        return;
+#endif
+
     head = ready_queue[prio];
 
     /* Only rotate if more than one thread at this priority */
     if (head && head->sched_link.next != head) {
         /* Invariant: running thread must be queue head for fair rotation.
-         * If curr != head, priority was changed while running - still safe
-         * because we rotate whatever is at head, maintaining FIFO order.
+         * If thread != head, priority was changed while running - still
+         * safe because we rotate whatever is at head, maintaining FIFO
+         * order.
          */
-        if (head != curr) {
-            /* Current thread not at head - it was re-prioritized.
+        if (head != thread) {
+            /* Thread not at head - it was re-prioritized.
              * Still rotate head for other waiters at this priority.
              */
             dbg_printf(DL_SCHEDULE,
                        "SCHED: yield curr %t != head %t at prio %d\n",
-                       curr->t_globalid, head->t_globalid, prio);
+                       thread->t_globalid, head->t_globalid, prio);
         }
         ready_queue[prio] = head->sched_link.next;
     }
+}
 
+/**
+ * Yield current thread's timeslice.
+ * Rotates thread to back of its priority queue for round-robin.
+ * IRQ-safe: protects critical section from interrupt corruption.
+ */
+void sched_yield(void)
+{
+    tcb_t *curr = thread_current();
+    uint32_t basepri;
+
+    if (!curr)
+        return;
+
+    basepri = irq_kernel_critical_enter();
+    sched_rotate(curr);
     irq_kernel_critical_exit(basepri);
 }
 
+/**
+ * ThreadSwitch: thread gives way to dest. A queued, runnable dest moves
+ * to the head of its level by turning the ring there, which keeps the
+ * cyclic order of the others; thread then yields its own level. Levels
+ * still decide who runs: dest is only next if nothing above it is ready.
+ * A NULL or blocked dest, or one in the EDF band, makes this a yield.
+ * IRQ-safe: protects critical section from interrupt corruption.
+ */
+void sched_switch_to(tcb_t *thread, tcb_t *dest)
+{
+    uint32_t basepri;
+    uint8_t prio;
+
+    basepri = irq_kernel_critical_enter();
+
+    if (dest && dest != thread && dest->state == T_RUNNABLE &&
+        sched_is_queued(dest)) {
+        prio = dest->priority;
+        if (prio >= SCHED_PRIORITY_LEVELS)
+            prio = SCHED_PRIO_IDLE;
+#ifdef CONFIG_SCHED_EDF
+        if (prio != SCHED_PRIO_EDF)
+#endif
+        {
+            /* Sharing dest's level, thread already ends up behind it */
+            if (prio != thread->priority)
+                sched_rotate(thread);
+            ready_queue[prio] = dest;
+            irq_kernel_critical_exit(basepri);
+            return;
+        }
+    }
+
+    sched_rotate(thread);
+    irq_kernel_critical_exit(basepri);
+}
+
+#ifdef CONFIG_SCHED_RR
+void sched_tick(void)
+{
+    tcb_t *curr = thread_current();
+    tcb_t *head, *thr;
+    int shared = 0;
+
+    if (!curr || !curr->timeslice || curr->state != T_RUNNABLE)
+        return;
+
+    /* The quantum only runs while another runnable thread shares the level,
+     * so a thread alone at its priority is never interrupted for nothing.
+     * Blocked threads still queued lazily do not count.
+     */
+    head = ready_queue[curr->priority];
+    if (head) {
+        thr = head;
+        do {
+            if (thr != curr && thr->state == T_RUNNABLE) {
+                shared = 1;
+                break;
+            }
+            thr = thr->sched_link.next;
+        } while (thr != head);
+    }
+    if (!shared) {
+        curr->quantum_left = curr->timeslice;
+        return;
+    }
+
+    if (curr->quantum_left > 1) {
+        --curr->quantum_left;
+        return;
+    }
+
+    curr->quantum_left = curr->timeslice;
+    sched_quantum_expired = curr;
+}
+#endif
+
+/**
+ * Act on an expired quantum: move curr from the head to the tail of its
+ * level. Not within the EDF band, whose order is by deadline, nor while
+ * curr holds a raised preemption threshold (ThreadX disables time-slicing
+ * then too). Caller must hold the kernel critical section.
+ *
+ * @return 1 if curr was rotated
+ */
+static int sched_quantum_rotate(tcb_t *curr)
+{
+#ifdef CONFIG_SCHED_RR
+    tcb_t *head;
+
+    if (!sched_quantum_expired)
+        return 0;
+
+    if (sched_quantum_expired != curr || curr->state != T_RUNNABLE ||
+        curr->preempt_threshold < curr->priority) {
+        sched_quantum_expired = NULL;
+        return 0;
+    }
+    sched_quantum_expired = NULL;
+
+#ifdef CONFIG_SCHED_EDF
+    if (curr->priority == SCHED_PRIO_EDF)
+        return 0;
+#endif
+
+    head = ready_queue[curr->priority];
+    if (head != curr || head->sched_link.next == head)
+        return 0;
+
+    ready_queue[curr->priority] = head->sched_link.next;
+    SCHED_STAT(rotate);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Whether thread, picked at level prio, preempts curr within the EDF band:
+ * both at SCHED_PRIO_EDF, thread due earlier, and curr has not raised its
+ * preemption threshold above the band.
+ */
+static inline int sched_edf_preempts(tcb_t *thread, tcb_t *curr, uint32_t prio)
+{
+#ifdef CONFIG_SCHED_EDF
+    return prio == SCHED_PRIO_EDF && curr->priority == SCHED_PRIO_EDF &&
+           curr->preempt_threshold == SCHED_PRIO_EDF &&
+           thread->edf_deadline < curr->edf_deadline;
+#else
+    return 0;
+#endif
+}
+
 /**
  * Select next thread to run with PTS enforcement.
  *
  * O(1) selection: CLZ gives highest priority, return queue head.
- * Strict invariant: all queued threads are runnable.
+ * Blocked threads left queued lazily are dropped on the way (amortized
+ * O(1): each is unlinked once).
+ *
+ * Round-robin: an expired quantum (CONFIG_SCHED_RR) rotates the current
+ * thread to the tail of its level first.
  *
  * PTS Enforcement: Task j preempts task i iff π_j < γ_i
  *   - If current thread has preemption threshold set, only threads with
@@ -269,11 +576,16 @@ tcb_t *schedule_select(void)
     tcb_t *thread;
     tcb_t *curr;
     uint32_t basepri;
+    int rotated;
 
     basepri = irq_kernel_critical_enter();
 
-    /* CLZ returns 32 if bitmap is 0 (no branches needed) */
-    prio = clz32(ready_bitmap);
+    curr = thread_current();
+    upcall_schedule(curr);
+    kmutex_schedule(curr);
+    rotated = sched_quantum_rotate(curr);
+
+    thread = sched_pick(&prio);
 
     if (prio >= SCHED_PRIORITY_LEVELS) {
         irq_kernel_critical_exit(basepri);
@@ -282,8 +594,6 @@ tcb_t *schedule_select(void)
         return NULL;
     }
 
-    thread = ready_queue[prio];
-
     /* Safety check for consistency */
     if (!thread) {
         irq_kernel_critical_exit(basepri);
@@ -291,20 +601,24 @@ tcb_t *schedule_select(void)
         return NULL;
     }
 
-    /* PTS Enforcement: check if current thread's threshold blocks preemption */
-    curr = thread_current();
-    if (curr && curr->state == T_RUNNABLE && curr != thread) {
+    /* PTS Enforcement: check if current thread's threshold blocks preemption.
+     * An expired quantum gives the CPU up like a yield, and so does a
+     * time-triggered thread parked outside its window.
+     */
+    if (curr && curr->state == T_RUNNABLE && curr != thread && !rotated &&
+        !tt_parked(curr)) {
         /* Preemption attempt: check threshold
          * Can preempt iff: priority < threshold (numerically)
          * Example: If threshold=10, only priorities 0-9 can preempt
          */
-        if (prio >= curr->preempt_threshold) {
+        if (prio >= curr->preempt_threshold &&
+            !sched_edf_preempts(thread, curr, prio)) {
             /* Priority doesn't exceed threshold - defer preemption
              * Mark CURRENT thread's priority in preempted bitmap,
              * not the candidate's priority
              */
             if (curr->preempt_threshold != curr->priority)
-                preempted_bitmap |= (1UL << (31 - curr->priority));
+                prio_bitmap_set(&preempted_bitmap, curr->priority);
 
             dbg_printf(DL_SCHEDULE,
                        "SCHED: PTS defer prio %d (curr %t thresh %d)\n", prio,
@@ -318,13 +632,54 @@ tcb_t *schedule_select(void)
     /* Either voluntary yield or priority exceeds threshold - allow switch
      * Clear preempted bit for the thread being switched to
      */
-    preempted_bitmap &= ~(1UL << (31 - prio));
+    prio_bitmap_clear(&preempted_bitmap, prio);
 
     irq_kernel_critical_exit(basepri);
-    /* Strict invariant: queued threads are always runnable */
+    /* sched_pick() only returns runnable threads */
     return thread;
 }
 
+/**
+ * Check whether thread is the one schedule_select() would pick next.
+ *
+ * Used by the IPC direct process switch: when the receiver is at the head
+ * of the highest ready level and the current thread's preemption threshold
+ * does not hold it off, switching to it directly gives the same result as
+ * PendSV followed by schedule_select(). The ceiling of a kernel mutex
+ * the current thread holds is applied first, as schedule_select() does;
+ * an expired quantum is left to schedule_select() to act on.
+ */
+int sched_is_next(tcb_t *thread)
+{
+    uint32_t prio;
+    tcb_t *curr;
+    uint32_t basepri;
+    int next = 0;
+
+    basepri = irq_kernel_critical_enter();
+
+#ifdef CONFIG_SCHED_RR
+    if (sched_quantum_expired) {
+        irq_kernel_critical_exit(basepri);
+        return 0;
+    }
+#endif
+
+    curr = thread_current();
+    kmutex_schedule(curr);
+
+    if (sched_pick(&prio) == thread) {
+        if (!curr || curr->state != T_RUNNABLE || curr == thread ||
+            prio < curr->preempt_threshold) {
+            prio_bitmap_clear(&preempted_bitmap, prio);
+            next = 1;
+        }
+    }
+
+    irq_kernel_critical_exit(basepri);
+    return next;
+}
+
 /**
  * Change thread priority safely.
  * Handles queue migration atomically if thread is queued.
@@ -355,13 +710,15 @@ void sched_set_priority(tcb_t *thread, uint8_t new_prio)
     /* Remove from old queue if queued */
     was_queued = sched_is_queued(thread);
     if (was_queued)
-        sched_dequeue(thread);
+        sched_unlink(thread);
 
     /* Update priority */
     thread->priority = new_prio;
 
-    /* Re-add to new queue if was queued */
-    if (was_queued)
+    /* Re-add to new queue if was queued; a blocked thread that was only
+     * left queued lazily is simply dropped.
+     */
+    if (was_queued && thread->state == T_RUNNABLE)
         sched_enqueue(thread);
 
     irq_kernel_critical_exit(basepri);
@@ -436,13 +793,15 @@ int sched_preemption_change(tcb_t *thread,
         /* Threshold was raised - check highest ready priority directly
          * and trigger immediate preemption if higher priority thread is ready
          */
-        uint32_t highest_ready_prio = clz32(ready_bitmap);
+        uint32_t highest_ready_prio;
+
+        sched_pick(&highest_ready_prio);
         if (highest_ready_prio < thread->preempt_threshold) {
             /* A higher priority thread is ready and can now preempt */
             should_reschedule = 1;
 
             /* Clear preempted bit for current thread since threshold raised */
-            preempted_bitmap &= ~(1UL << (31 - thread->priority));
+            prio_bitmap_clear(&preempted_bitmap, thread->priority);
 
             dbg_printf(
                 DL_SCHEDULE,
@@ -451,7 +810,7 @@ int sched_preemption_change(tcb_t *thread,
         } else {
             /* Clear preempted bit if threshold now matches priority */
             if (thread->preempt_threshold == thread->priority) {
-                preempted_bitmap &= ~(1UL << (31 - thread->priority));
+                prio_bitmap_clear(&preempted_bitmap, thread->priority);
             }
         }
     }
@@ -467,6 +826,221 @@ int sched_preemption_change(tcb_t *thread,
     return 0;
 }
 
+#ifdef CONFIG_SCHED_EDF
+/**
+ * Move thread to a new deadline, keeping the EDF queue sorted.
+ */
+static void sched_edf_requeue(tcb_t *thread, uint64_t deadline)
+{
+    uint32_t basepri = irq_kernel_critical_enter();
+    int was_queued =
+        sched_is_queued(thread) && thread->priority == SCHED_PRIO_EDF;
+
+    if (was_queued)
+        sched_unlink(thread);
+
+    thread->edf_deadline = deadline;
+
+    if (was_queued && thread->state == T_RUNNABLE)
+        sched_enqueue(thread);
+
+    irq_kernel_critical_exit(basepri);
+}
+
+/**
+ * Periodic release of an EDF thread (ktimer callback, softirq context).
+ * Deadlines equal periods, so the job released one period ago is due now:
+ * if the thread is still runnable it missed. The next job's deadline is
+ * one period on; the thread is told through SCHED_EDF_RELEASE_BIT.
+ */
+static uint32_t sched_edf_release(void *data)
+{
+    ktimer_event_t *event = (ktimer_event_t *) data;
+    tcb_t *thr = (tcb_t *) event->data;
+    uint64_t now;
+
+    if (!thr || !thr->edf_period)
+        return 0;
+
+    if (thr->state == T_RUNNABLE)
+        ++thr->edf_misses;
+
+    sched_edf_requeue(thr, thr->edf_deadline + thr->edf_period);
+
+    notification_signal(thr, SCHED_EDF_RELEASE_BIT);
+    notify_wake_thread(thr);
+
+    /* The next release is the new deadline. Measure it from the deadline
+     * rather than from now, so a late callback doesn't drift the period.
+     */
+    now = ktimer_get_now();
+    return (thr->edf_deadline > now) ? (uint32_t) (thr->edf_deadline - now)
+                                     : 1;
+}
+
+int sched_edf_set(tcb_t *thread, uint32_t period)
+{
+    if (thread->edf_release.data) {
+        ktimer_event_cancel(&thread->edf_release);
+        thread->edf_release.data = NULL;
+    }
+
+    thread->edf_period = period;
+
+    if (!period) {
+        sched_edf_requeue(thread, SCHED_EDF_NO_DEADLINE);
+        return 0;
+    }
+
+    /* First job is released now */
+    sched_edf_requeue(thread, ktimer_get_now() + period);
+
+    if (ktimer_event_arm(&thread->edf_release, period, sched_edf_release,
+                         thread) < 0) {
+        thread->edf_release.data = NULL;
+        thread->edf_period = 0;
+        sched_edf_requeue(thread, SCHED_EDF_NO_DEADLINE);
+        return -1;
+    }
+
+    return 0;
+}
+#endif /* CONFIG_SCHED_EDF */
+
+#ifdef CONFIG_SCHED_ADMISSION
+/* Declared demand of a budgeted thread, in ktimer ticks */
+typedef struct {
+    tcb_t *thread;
+    uint32_t budget;
+    uint32_t period; /* also the deadline */
+    uint8_t prio;
+} sched_rta_task_t;
+
+/* Threads admitted with a budget. Slots whose thread has since dropped
+ * its budget are reclaimed by the next sched_admit().
+ */
+static tcb_t *sched_rta_set[CONFIG_SCHED_ADMISSION_MAX];
+
+/* Task set under analysis: sched_rta_set, plus or with a candidate */
+static sched_rta_task_t sched_rta_tasks[CONFIG_SCHED_ADMISSION_MAX];
+
+/**
+ * Worst-case response time of sched_rta_tasks[i] (Joseph and Pandya):
+ * the smallest R = C_i + sum(ceil(R / T_j) * C_j) over the other tasks
+ * at the same or a higher level. A budget enforced as a sporadic server
+ * bounds each task's demand like a periodic task of the same C and T.
+ * Blocking on lower-priority threads, and threads without a budget, are
+ * not accounted for.
+ *
+ * @return R in ticks, or 0 if R exceeds the task's period
+ */
+static uint32_t sched_rta_response(int i, int n)
+{
+    sched_rta_task_t *task = &sched_rta_tasks[i];
+    uint64_t r = task->budget, next;
+
+    for (;;) {
+        next = task->budget;
+        for (int j = 0; j < n; ++j) {
+            sched_rta_task_t *hp = &sched_rta_tasks[j];
+
+            if (j != i && hp->prio <= task->prio)
+                next += (uint64_t) ((r + hp->period - 1) / hp->period) *
+                        hp->budget;
+        }
+
+        if (next > task->period)
+            return 0;
+        if (next == r)
+            return (uint32_t) r;
+        r = next;
+    }
+}
+
+/* Load sched_rta_set into sched_rta_tasks, skipping thread */
+static int sched_rta_load(tcb_t *thread)
+{
+    int n = 0;
+
+    for (int i = 0; i < CONFIG_SCHED_ADMISSION_MAX; ++i) {
+        tcb_t *thr = sched_rta_set[i];
+
+        if (!thr || thr == thread || !thr->budget)
+            continue;
+
+        sched_rta_tasks[n].thread = thr;
+        sched_rta_tasks[n].budget = thr->budget;
+        sched_rta_tasks[n].period = thr->budget_period;
+        sched_rta_tasks[n].prio = thr->user_priority;
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * Admission control: whether every budgeted thread still meets its
+ * period once thread declares prio, budget and period. On success thread
+ * joins the analysed set, which it leaves by dropping its budget.
+ * Cost is O(n^2) per fixed-point step, n <= CONFIG_SCHED_ADMISSION_MAX.
+ *
+ * @return 0 if admitted, -1 if the set would be unschedulable or full
+ */
+int sched_admit(tcb_t *thread, uint8_t prio, uint32_t budget, uint32_t period)
+{
+    int i, n, slot = -1;
+
+    /* Without a budget the thread makes no claim and gets no bound */
+    if (!budget)
+        return 0;
+
+    if (budget > period)
+        return -1;
+
+    /* The set is full of other threads: no room for this one */
+    n = sched_rta_load(thread);
+    if (n == CONFIG_SCHED_ADMISSION_MAX)
+        return -1;
+
+    sched_rta_tasks[n].thread = thread;
+    sched_rta_tasks[n].budget = budget;
+    sched_rta_tasks[n].period = period;
+    sched_rta_tasks[n].prio = prio;
+    ++n;
+
+    for (i = 0; i < n; ++i) {
+        if (!sched_rta_response(i, n)) {
+            dbg_printf(DL_SCHEDULE, "SCHED: %t not admitted, %t misses\n",
+                       thread->t_globalid,
+                       sched_rta_tasks[i].thread->t_globalid);
+            return -1;
+        }
+    }
+
+    for (i = 0; i < CONFIG_SCHED_ADMISSION_MAX; ++i) {
+        tcb_t *thr = sched_rta_set[i];
+
+        if (thr == thread)
+            return 0;
+        if (slot < 0 && (!thr || !thr->budget))
+            slot = i;
+    }
+
+    if (slot < 0)
+        return -1;
+
+    sched_rta_set[slot] = thread;
+    return 0;
+}
+
+void sched_admit_remove(tcb_t *thread)
+{
+    for (int i = 0; i < CONFIG_SCHED_ADMISSION_MAX; ++i) {
+        if (sched_rta_set[i] == thread)
+            sched_rta_set[i] = NULL;
+    }
+}
+#endif /* CONFIG_SCHED_ADMISSION */
+
 /**
  * Main scheduler entry point.
  * Selects next thread and switches to it.
@@ -479,3 +1053,84 @@ int schedule(void)
     thread_switch(scheduled);
     return 1;
 }
+
+#ifdef CONFIG_KDB
+uint32_t sched_stat(uint32_t which)
+{
+    switch (which) {
+    case SCHEDSTAT_CRIT:
+        return sched_stats.crit;
+    case SCHEDSTAT_ENQUEUE:
+        return sched_stats.enqueue;
+    case SCHEDSTAT_DEQUEUE:
+        return sched_stats.dequeue;
+    case SCHEDSTAT_LAZY_HIT:
+        return sched_stats.lazy_hit;
+    case SCHEDSTAT_LAZY_DROP:
+        return sched_stats.lazy_drop;
+    case SCHEDSTAT_ROTATE:
+        return sched_stats.rotate;
+    default:
+        return 0;
+    }
+}
+
+void kdb_show_sched(void)
+{
+#ifdef CONFIG_SCHED_PRIO_256
+    dbg_printf(DL_KDB, "Ready summary: %p\n", ready_bitmap.summary);
+    for (int g = 0; g < SCHED_PRIORITY_LEVELS / 32; ++g) {
+        if (ready_bitmap.group[g])
+            dbg_printf(DL_KDB, "Ready bitmap [%d-%d]: %p\n", g * 32,
+                       g * 32 + 31, ready_bitmap.group[g]);
+    }
+#else
+    dbg_printf(DL_KDB, "Ready bitmap: %p\n", ready_bitmap.group[0]);
+#endif
+    dbg_printf(DL_KDB, "Critical sections: %d\n", sched_stats.crit);
+    dbg_printf(DL_KDB, "Enqueues: %d\nDequeues: %d\n", sched_stats.enqueue,
+               sched_stats.dequeue);
+    dbg_printf(DL_KDB, "Lazy wakeups: %d\nLazy drops: %d\n",
+               sched_stats.lazy_hit, sched_stats.lazy_drop);
+    dbg_printf(DL_KDB, "Quantum rotations: %d\n", sched_stats.rotate);
+
+#ifdef CONFIG_SCHED_EDF
+    if (ready_queue[SCHED_PRIO_EDF]) {
+        tcb_t *head = ready_queue[SCHED_PRIO_EDF], *thr = head;
+
+        dbg_printf(DL_KDB, "EDF queue (now %ld):\n", ktimer_get_now());
+        do {
+            dbg_printf(DL_KDB, "  %t deadline %ld period %d misses %d\n",
+                       thr->t_globalid, thr->edf_deadline, thr->edf_period,
+                       thr->edf_misses);
+            thr = thr->sched_link.next;
+        } while (thr != head);
+    }
+#endif
+
+#ifdef CONFIG_SCHED_ADMISSION
+    {
+        int n = sched_rta_load(NULL);
+
+        if (n)
+            dbg_printf(DL_KDB, "Admitted (ticks):\n");
+        for (int i = 0; i < n; ++i) {
+            sched_rta_task_t *task = &sched_rta_tasks[i];
+            uint32_t r = sched_rta_response(i, n);
+
+            dbg_printf(DL_KDB, "  %t prio %d C %d T %d R ",
+                       task->thread->t_globalid, task->prio, task->budget,
+                       task->period);
+            if (r)
+                dbg_printf(DL_KDB, "%d\n", r);
+            else
+                dbg_printf(DL_KDB, "> T\n");
+        }
+    }
+#endif
+
+#ifdef CONFIG_SCHED_TT
+    kdb_show_tt();
+#endif
+}
+#endif /* CONFIG_KDB */
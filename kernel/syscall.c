@@ -3,9 +3,14 @@
  * found in the LICENSE file.
  */
 
+#include <budget.h>
+#include <cputime.h>
 #include <debug.h>
+#include <hrtimer.h>
 #include <init_hook.h>
 #include <ipc.h>
+#include <kmutex.h>
+#include <lathist.h>
 #include <ktimer.h>
 #include <l4/utcb.h>
 #include <memory.h>
@@ -13,10 +18,13 @@
 #include <platform/armv7m.h>
 #include <platform/ipc-fastpath.h>
 #include <platform/irq.h>
+#include <release.h>
 #include <sched.h>
 #include <softirq.h>
 #include <syscall.h>
 #include <thread.h>
+#include <tt.h>
+#include <upcall.h>
 
 #include INC_PLAT(systick.h)
 
@@ -32,7 +40,17 @@
 
 tcb_t *caller;
 
-/* Always returns 0; fastpath and slowpath both use PendSV for context switching
+#ifdef CONFIG_KDB
+/* IPC fastpath coverage, shown by KDB */
+static uint32_t ipc_fastpath_hits, ipc_fastpath_misses;
+#endif
+
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+tcb_t *ipc_direct_switch;
+#endif
+
+/* Returns nonzero when svc_handler has to switch directly to
+ * ipc_direct_switch; otherwise the context switch goes through PendSV.
  */
 int __svc_handler(void)
 {
@@ -60,21 +78,46 @@ int __svc_handler(void)
 
         /* Try fastpath with saved message registers */
         if (ipc_fastpath_helper(caller, svc_param, __irq_saved_regs)) {
-            /* Fastpath succeeded - MRs copied, threads enqueued, PendSV
-             * requested. Caller is already T_RUNNABLE and enqueued by fastpath.
+            /* Fastpath succeeded - MRs copied, receiver enqueued, PendSV
+             * requested. Caller is either T_RUNNABLE and enqueued (send)
+             * or T_RECV_BLOCKED (Call/ReplyWait).
              * Just return normally - PendSV will do the context switch. */
+#ifdef CONFIG_KDB
+            ipc_fastpath_hits++;
+#endif
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+            if (ipc_direct_switch) {
+                /* As schedule_in_irq() does for PendSV: a thread that
+                 * only ever switches directly must still be checked.
+                 */
+                if (!thread_check_canary(caller)) {
+                    panic(
+                        "Stack overflow (current): tid=%t, "
+                        "stack_base=%p, canary=%p\n",
+                        caller->t_globalid, caller->stack_base,
+                        caller->stack_base
+                            ? *((uint32_t *) caller->stack_base)
+                            : 0);
+                }
+                return 1; /* svc_handler switches to the receiver */
+            }
+#endif
             return 0; /* Normal return, PendSV will switch */
         }
 
-        /* Fastpath failed, use slowpath */
-        /* Slowpath will dequeue caller in softirq handler */
-        sched_dequeue(caller);
+#ifdef CONFIG_KDB
+        ipc_fastpath_misses++;
+#endif
+
+        /* Fastpath failed, use slowpath.
+         * Caller stays in its ready queue (lazy queueing); the softirq
+         * handler either wakes it in place or leaves it blocked.
+         */
         caller->state = T_SVC_BLOCKED;
         softirq_schedule(SYSCALL_SOFTIRQ);
         return 0;
     } else {
         /* Non-IPC syscall */
-        sched_dequeue(caller);
         caller->state = T_SVC_BLOCKED;
         softirq_schedule(SYSCALL_SOFTIRQ);
         return 0;
@@ -92,8 +135,17 @@ void svc_handler(void)
         "stm r0, {r4-r11}" ::
             : "r0", "memory");
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    /* Direct process switch: save the caller and load the IPC partner
+     * right here, returning from SVC into the partner. context_switch
+     * pops LR and exits, so nothing below runs in that case.
+     */
+    if (__svc_handler())
+        context_switch(current, ipc_direct_switch);
+#else
     /* Call C handler - always returns 0 (context switch via PendSV) */
     __svc_handler();
+#endif
 
     /* Restore R4-R11 BEFORE returning so PendSV saves original values */
     __asm__ __volatile__(
@@ -125,14 +177,17 @@ INIT_HOOK(syscall_init, INIT_LEVEL_KERNEL);
  *   R1: time_control - timeslice control
  *   R2: processor_control - processor number
  *   R3: prio_control - priority and stride
- *   R4: preemption_control - preemption threshold (PTS)
+ *   R4: preemption_control - preemption threshold (PTS); with bit 25
+ *       set (L4_HS_Schedule), R1 names the user-level scheduler instead
+ *       and bits 26-31 the notification bit posted to it; with bit 24
+ *       set, bit 0 turns the IPC direct process switch off for dest
  *   R5: old_control (output pointer)
  *
  * WCET Analysis:
  *   - thread_by_globalid(): O(1) lookup (~10 instructions)
  *   - Priority update: O(1) via sched_set_priority() (~50 instructions)
  *     - sched_is_queued(): O(1) pointer check
- *     - sched_dequeue(): O(1) list ops + bitmap clear
+ *     - sched_unlink(): O(1) list ops + bitmap clear
  *     - sched_enqueue(): O(1) list ops + bitmap set
  *   - Threshold update: O(1) via sched_preemption_change() (~30 instructions)
  *     - Validation: O(1) range checks
@@ -144,9 +199,37 @@ INIT_HOOK(syscall_init, INIT_LEVEL_KERNEL);
  *   Total WCET: O(1) - approximately 100 instructions
  *   At 168 MHz: ~0.6 microseconds worst case (bounded and deterministic)
  */
+/* L4 time period (microseconds) to ktimer ticks */
+static inline uint32_t sched_time_ticks(uint16_t raw)
+{
+    ipc_time_t t = {.raw = raw};
+
+    return (t.period.m << t.period.e) /
+           ((1000000) / (CORE_CLOCK / CONFIG_KTIMER_HEARTBEAT));
+}
+
+/* Budget and replenishment period in ticks from time control; a total
+ * quantum of L4_Never (0) means no budget.
+ */
+static void sched_time_budget(uint32_t time_control,
+                              uint32_t *budget,
+                              uint32_t *period)
+{
+    *budget = 0;
+    *period = 0;
+
+    if (time_control & 0xFFFF) {
+        *budget = sched_time_ticks(time_control & 0xFFFF);
+        *period = sched_time_ticks(time_control >> 16);
+        if (!*budget)
+            *budget = 1;
+    }
+}
+
 static void sys_schedule(uint32_t *param1, uint32_t *param2)
 {
     l4_thread_t dest = param1[REG_R0];
+    uint32_t time_control = param1[REG_R1];
     uint32_t prio_control = param1[REG_R3];
     uint32_t preemption_control = param2[0];        /* R4 */
     uint32_t *old_control = (uint32_t *) param2[1]; /* R5 */
@@ -159,29 +242,135 @@ static void sys_schedule(uint32_t *param1, uint32_t *param2)
 
     /* Extract priority from prio_control (lower 8 bits) */
     uint8_t new_priority = prio_control & 0xFF;
+    int prio_change =
+        new_priority != 0xFF && new_priority < SCHED_PRIORITY_LEVELS;
+    uint8_t prio = prio_change ? new_priority : target->user_priority;
 
     /* Extract preemption threshold from preemption_control (bits 16-23) */
     uint8_t new_threshold = (preemption_control >> 16) & 0xFF;
 
+    /* Delegation to a user-level scheduler (see upcall.h); time control
+     * then carries the scheduler's ID, so it is left unchanged. ~0, which
+     * most wrappers pass, changes nothing (it names no valid bit).
+     */
+    int delegate =
+        preemption_control != ~0UL && (preemption_control & (1UL << 25));
+    l4_thread_t upcall_sched = time_control;
+
+    uint32_t budget = 0, period = 0;
+
+#ifdef CONFIG_SCHED_TT
+    /* Time-triggered windows: bits 16-31 name a DECLARE_TT_WINDOW entry
+     * (1-based) to add to the thread's windows. Any other priority
+     * releases them all.
+     */
+    uint32_t window =
+        (prio_change && new_priority == SCHED_PRIO_TT) ? prio_control >> 16
+                                                       : 0;
+#endif
+
     /* Save old control value if requested */
     if (old_control)
         *old_control = (target->preempt_threshold << 16) | target->priority;
 
+    /* Check the whole request before changing anything, so that a
+     * rejected call has no effect.
+     */
+    if (delegate) {
+        if (upcall_valid(target, upcall_sched) < 0)
+            goto error;
+        time_control = ~0UL;
+    }
+
+    if (time_control != ~0UL) {
+        sched_time_budget(time_control, &budget, &period);
+        if (!budget_valid(budget, period))
+            goto error;
+    }
+
+#ifdef CONFIG_SCHED_TT
+    if (prio_change && tt_bindable(target, window) < 0)
+        goto error;
+#endif
+
+    /* The threshold must be at or above the priority it ends up with */
+    if (new_threshold != 0xFF && new_threshold > prio)
+        goto error;
+
+#ifdef CONFIG_SCHED_ADMISSION
+    /* Admission control (see sched_admit()): the declared priority and
+     * budget after this call must keep every budgeted thread within its
+     * period. Checked last: admission enters target into the analysed set.
+     */
+    if (time_control == ~0UL) {
+        budget = target->budget;
+        period = target->budget_period;
+    }
+    if (sched_admit(target, prio, budget, period) < 0)
+        goto error;
+#endif
+
+    if (delegate)
+        upcall_set(target, upcall_sched, preemption_control >> 26);
+
     /* Update priority if specified (0xFF means "don't change") */
-    if (new_priority != 0xFF && new_priority < SCHED_PRIORITY_LEVELS) {
-        sched_set_priority(target, new_priority);
+    if (prio_change) {
+#ifdef CONFIG_SCHED_EDF
+        /* Entering the EDF band: bits 16-31 carry the relative deadline
+         * (= period) as an L4 time period. Any other priority leaves it.
+         * Arming the release only fails for a zero period, which is none.
+         */
+        sched_edf_set(target, (new_priority == SCHED_PRIO_EDF)
+                                  ? sched_time_ticks(prio_control >> 16)
+                                  : 0);
+#endif
+#ifdef CONFIG_SCHED_TT
+        tt_bind(target, window);
+#endif
+        /* An exhausted budget holds the thread at the background level;
+         * the new priority applies once it is replenished. Callers
+         * blocked on target may hold it higher.
+         */
         target->user_priority = new_priority;
-        target->base_priority = new_priority;
+        if (!budget_exhausted(target)) {
+            target->base_priority = new_priority;
+            thread_sc_update(target);
+        }
     }
 
-    /* Update preemption threshold if specified (0xFF means "don't change") */
-    if (new_threshold != 0xFF) {
-        if (sched_preemption_change(target, new_threshold, NULL) < 0) {
-            param1[REG_R0] = L4_SCHEDRESULT_ERROR;
-            return;
+    /* Update time control if specified (~0 means "don't change"). Bits
+     * 0-15 are the total quantum, i.e. the CPU budget. If it is finite,
+     * bits 16-31 are the budget's replenishment period; if it is L4_Never
+     * (0), the budget is removed and bits 16-31 are the round-robin
+     * timeslice, L4_Never for none. All are L4 time periods.
+     */
+    if (time_control != ~0UL) {
+#ifdef CONFIG_SCHED_RR
+        if (!budget) {
+            uint32_t timeslice = 0;
+
+            if (time_control >> 16) {
+                timeslice = sched_time_ticks(time_control >> 16);
+                if (!timeslice)
+                    timeslice = 1;
+            }
+            target->timeslice = timeslice;
+            target->quantum_left = timeslice;
         }
+#endif
+        budget_set(target, budget, period);
     }
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    /* Direct switch opt-out, for measuring it; ~0 changes nothing */
+    if (preemption_control != ~0UL && (preemption_control & (1UL << 24)))
+        target->ipc_direct_off = preemption_control & 1;
+#endif
+
+    /* Update preemption threshold if specified (0xFF means "don't change") */
+    if (new_threshold != 0xFF)
+        sched_preemption_change(target, new_threshold, NULL);
+
     /* Return thread state */
     switch (target->state) {
     case T_INACTIVE:
@@ -200,13 +389,18 @@ static void sys_schedule(uint32_t *param1, uint32_t *param2)
         param1[REG_R0] = L4_SCHEDRESULT_WAITING;
         break;
     case T_NOTIFY_BLOCKED:
-        /* Thread blocked on SYS_NOTIFY_WAIT - report as waiting */
+    case T_MUTEX_BLOCKED:
+        /* Blocked on SYS_NOTIFY_WAIT or SYS_KMUTEX - report as waiting */
         param1[REG_R0] = L4_SCHEDRESULT_WAITING;
         break;
     default:
         param1[REG_R0] = L4_SCHEDRESULT_ERROR;
         break;
     }
+    return;
+
+error:
+    param1[REG_R0] = L4_SCHEDRESULT_ERROR;
 }
 
 static void sys_thread_control(uint32_t *param1, uint32_t *param2)
@@ -257,14 +451,41 @@ static void sys_thread_control(uint32_t *param1, uint32_t *param2)
     }
 }
 
+/**
+ * ThreadSwitch: R0 names the thread to run next, L4_NILTHREAD to just
+ * yield. Priorities still rule: dest only goes to the head of its level
+ * (see sched_switch_to()), and the caller yields its own.
+ */
+static void sys_thread_switch(uint32_t *param1)
+{
+    l4_thread_t dest = param1[REG_R0];
+
+    caller->state = T_RUNNABLE;
+    sched_enqueue(caller);
+    sched_switch_to(caller, (dest != L4_NILTHREAD)
+                                ? thread_by_globalid(dest)
+                                : NULL);
+}
+
+#define TIMER_USEC_PER_TICK (1000000 / (CORE_CLOCK / CONFIG_KTIMER_HEARTBEAT))
+
+/* Microseconds to ktimer ticks, rounded up */
+static inline uint32_t timer_usec_ticks(uint32_t usec)
+{
+    return usec / TIMER_USEC_PER_TICK + (usec % TIMER_USEC_PER_TICK != 0);
+}
+
 /**
  * Timer notification syscall handler.
  * Creates a timer that delivers notifications to the calling thread.
  *
  * Parameters:
- *   R0: ticks - timer delay/period in system ticks
+ *   R0: ticks - timer delay/period in system ticks, or in microseconds
+ *       with TIMER_NOTIFY_USEC
  *   R1: notify_bits - notification bit mask to signal
- *   R2: periodic - 0 for one-shot, 1 for periodic timer
+ *   R2: flags - TIMER_NOTIFY_PERIODIC (any other non-zero value in the
+ *       low 16 bits but TIMER_NOTIFY_USEC alone also means periodic),
+ *       TIMER_NOTIFY_USEC, TIMER_NOTIFY_SLACK(n)
  *
  * Returns (R0):
  *   Non-zero timer handle on success
@@ -276,7 +497,8 @@ static void sys_thread_control(uint32_t *param1, uint32_t *param2)
  *   - ktimer_event_create_notify(): O(1) - ~150 instructions
  *     - ktable_alloc(): O(1) bitmap scan
  *     - ktimer_event_schedule(): O(k) where k = active timers
- *       Typically k < 10, worst case O(64) for CONFIG_MAX_KT_EVENTS
+ *       Typically k < 10, worst case O(64) for CONFIG_MAX_KT_EVENTS;
+ *       O(1) with CONFIG_KTIMER_WHEEL
  *   - Return: O(1) - ~5 instructions
  *
  *   Total WCET: O(k) where k = active timers
@@ -287,6 +509,9 @@ static void sys_thread_control(uint32_t *param1, uint32_t *param2)
  *   - Validates notify_bits (non-zero required)
  *   - Validates ticks (non-zero required)
  *   - Validates periodic flag (0 or 1)
+ *   - Microsecond periods round up to whole ticks, microsecond slack
+ *     down; only one-shot microsecond timers with less than a tick of
+ *     slack use the high-resolution timer
  *   - Current thread always valid (checked by kernel)
  *   - ktimer pool exhaustion returns 0 (graceful degradation)
  */
@@ -294,7 +519,9 @@ static void sys_timer_notify(uint32_t *param1)
 {
     uint32_t ticks = param1[REG_R0];
     uint32_t notify_bits = param1[REG_R1];
-    uint32_t periodic = param1[REG_R2];
+    uint32_t flags = param1[REG_R2];
+    uint32_t slack = flags >> TIMER_NOTIFY_SLACK_SHIFT;
+    uint32_t periodic;
     tcb_t *current = thread_current();
 
     /* Validate parameters */
@@ -304,18 +531,70 @@ static void sys_timer_notify(uint32_t *param1)
     }
 
     /* Clamp periodic to boolean */
-    periodic = (periodic != 0) ? 1 : 0;
+    periodic = (flags & 0xFFFF & ~TIMER_NOTIFY_USEC) ? 1 : 0;
+
+    if (flags & TIMER_NOTIFY_USEC) {
+#ifdef CONFIG_KTIMER_HIRES
+        /* With a tick of slack, a tick timer that can batch will do */
+        if (!periodic && slack < TIMER_USEC_PER_TICK) {
+            param1[REG_R0] = hrtimer_notify(current, ticks, notify_bits);
+            return;
+        }
+#endif
+        ticks = timer_usec_ticks(ticks);
+        slack /= TIMER_USEC_PER_TICK;
+    }
 
     /* Create notification timer */
-    ktimer_event_t *timer =
-        ktimer_event_create_notify(ticks, current, notify_bits, periodic);
+    ktimer_event_t *timer = ktimer_event_create_notify(ticks, current,
+                                                       notify_bits, periodic,
+                                                       slack);
 
     /* Return timer handle (or 0 on failure) */
     param1[REG_R0] = (uint32_t) timer;
 
     dbg_printf(DL_SYSCALL,
-               "SYS_TIMER_NOTIFY: ticks=%d bits=0x%x periodic=%d -> %p\n",
-               ticks, notify_bits, periodic, timer);
+               "SYS_TIMER_NOTIFY: ticks=%d bits=0x%x periodic=%d slack=%d "
+               "-> %p\n",
+               ticks, notify_bits, periodic, slack, timer);
+}
+
+/**
+ * Timer control syscall handler.
+ * Cancels or queries a notification timer of the caller.
+ *
+ * Parameters:
+ *   R0: op (timer_ctl_t)
+ *   R1: timer handle from SYS_TIMER_NOTIFY
+ *
+ * Returns (R0):
+ *   TIMER_CANCEL: 0
+ *   TIMER_OVERRUN: expiries that merged with an undelivered one since
+ *   the last query
+ *   ~0 for an unknown op, or a handle that is not a pending timer
+ *   notifying the caller
+ */
+static void sys_timer_control(uint32_t *param1)
+{
+    ktimer_event_t *kte = ktimer_notify_lookup(param1[REG_R1], caller);
+
+    if (!kte) {
+        param1[REG_R0] = ~0;
+        return;
+    }
+
+    switch (param1[REG_R0]) {
+    case TIMER_CANCEL:
+        param1[REG_R0] = ktimer_event_cancel(kte) ? ~0 : 0;
+        break;
+    case TIMER_OVERRUN:
+        param1[REG_R0] = kte->overrun;
+        kte->overrun = 0;
+        break;
+    default:
+        param1[REG_R0] = ~0;
+        break;
+    }
 }
 
 /**
@@ -506,6 +785,36 @@ static void sys_system_clock(uint32_t *param1)
     param1[REG_R1] = (uint32_t) (usec >> 32); /* High 32 bits */
 }
 
+/**
+ * CPU time syscall handler.
+ * Reads per-thread or system-wide CPU time accounting.
+ *
+ * Parameters:
+ *   R0: selector (cputime_t)
+ *   R1: thread global ID for CPUTIME_THREAD; nilthread means the caller
+ *
+ * Returns (R0, R1):
+ *   R0: Low 32 bits of cycles
+ *   R1: High 32 bits of cycles
+ *   0 for an unknown selector or thread, or without CONFIG_CPU_ACCOUNTING
+ */
+static void sys_cpu_time(uint32_t *param1)
+{
+    cputime_t which = param1[REG_R0];
+    l4_thread_t tid = param1[REG_R1];
+    tcb_t *thr = NULL;
+    uint64_t cycles = 0;
+
+    if (which == CPUTIME_THREAD)
+        thr = tid ? thread_by_globalid(tid) : caller;
+
+    if (which != CPUTIME_THREAD || thr)
+        cycles = cputime_get(which, thr);
+
+    param1[REG_R0] = (uint32_t) cycles;
+    param1[REG_R1] = (uint32_t) (cycles >> 32);
+}
+
 void syscall_handler()
 {
     uint32_t *svc_param1 = (uint32_t *) caller->ctx.sp;
@@ -525,6 +834,10 @@ void syscall_handler()
         sys_schedule(svc_param1, svc_param2);
         caller->state = T_RUNNABLE;
         sched_enqueue(caller);
+    } else if (svc_num == SYS_THREAD_SWITCH) {
+        /* Give way to another thread, or yield */
+        sys_thread_switch(svc_param1);
+        /* Note: sys_thread_switch handles state/enqueue internally */
     } else if (svc_num == SYS_SYSTEM_CLOCK) {
         /* System clock syscall - return monotonic time in microseconds */
         sys_system_clock(svc_param1);
@@ -535,6 +848,11 @@ void syscall_handler()
         sys_timer_notify(svc_param1);
         caller->state = T_RUNNABLE;
         sched_enqueue(caller);
+    } else if (svc_num == SYS_TIMER_CONTROL) {
+        /* Timer control - cancel or query a notification timer */
+        sys_timer_control(svc_param1);
+        caller->state = T_RUNNABLE;
+        sched_enqueue(caller);
     } else if (svc_num == SYS_NOTIFY_WAIT) {
         /* Notification wait - block until bits arrive */
         sys_notify_wait(svc_param1);
@@ -549,6 +867,37 @@ void syscall_handler()
         sys_notify_clear(svc_param1);
         caller->state = T_RUNNABLE;
         sched_enqueue(caller);
+    } else if (svc_num == SYS_CPU_TIME) {
+        /* CPU time accounting - read thread or system-wide cycles */
+        sys_cpu_time(svc_param1);
+        caller->state = T_RUNNABLE;
+        sched_enqueue(caller);
+#ifdef CONFIG_KMUTEX
+    } else if (svc_num == SYS_KMUTEX) {
+        /* Priority-ceiling mutex - may block the caller */
+        kmutex_syscall(caller, svc_param1);
+        /* Note: kmutex_syscall handles state/enqueue internally */
+#endif
+#ifdef CONFIG_LATENCY_HISTOGRAM
+    } else if (svc_num == SYS_LATENCY) {
+        /* Latency histograms - copy one out to the caller */
+        lathist_syscall(caller, svc_param1);
+        caller->state = T_RUNNABLE;
+        sched_enqueue(caller);
+#endif
+#ifdef CONFIG_KDB
+    } else if (svc_num == SYS_SCHED_STATS) {
+        /* Scheduler queue statistics, for tests */
+        svc_param1[REG_R0] = sched_stat(svc_param1[REG_R0]);
+        caller->state = T_RUNNABLE;
+        sched_enqueue(caller);
+#endif
+#ifdef CONFIG_PERIODIC_RELEASE
+    } else if (svc_num == SYS_RELEASE) {
+        /* Absolute periodic release - RELEASE_WAIT may block the caller */
+        release_syscall(caller, svc_param1);
+        /* Note: release_syscall handles state/enqueue internally */
+#endif
     } else if (svc_num == SYS_IPC) {
         sys_ipc(svc_param1);
         dbg_printf(DL_KDB, "SYSCALL: sys_ipc returned\n");
@@ -560,3 +909,16 @@ void syscall_handler()
         sched_enqueue(caller);
     }
 }
+
+#ifdef CONFIG_KDB
+void kdb_show_ipc_fastpath(void)
+{
+    uint32_t total = ipc_fastpath_hits + ipc_fastpath_misses;
+
+    dbg_printf(DL_KDB, "Hits: %d\nMisses: %d\n", ipc_fastpath_hits,
+               ipc_fastpath_misses);
+    if (total)
+        dbg_printf(DL_KDB, "Coverage: %d%%\n",
+                   (ipc_fastpath_hits * 100) / total);
+}
+#endif /* CONFIG_KDB */
@@ -101,10 +101,9 @@ void switch_to_kernel(void)
 
 void set_kernel_state(thread_state_t state)
 {
-    /* Strict queue invariant: dequeue before blocking */
-    if (state != T_RUNNABLE)
-        sched_dequeue(kernel);
-
+    /* Lazy queueing: a blocking kernel thread stays queued until
+     * schedule_select() drops it, so waking it again is usually free.
+     */
     kernel->state = state;
 
     if (state == T_RUNNABLE)
@@ -3,15 +3,24 @@
  * found in the LICENSE file.
  */
 
+#include <budget.h>
+#include <cputime.h>
 #include <debug.h>
 #include <error.h>
 #include <fpage_impl.h>
 #include <init_hook.h>
+#include <ipc.h>
+#include <kmutex.h>
+#include <lathist.h>
 #include <lib/ktable.h>
+#include <lib/stdlib.h>
 #include <platform/armv7m.h>
 #include <platform/irq.h>
+#include <release.h>
 #include <sched.h>
 #include <thread.h>
+#include <tt.h>
+#include <upcall.h>
 
 /**
  * @file    thread.c
@@ -24,8 +33,11 @@
  * which gives at least 4  * 512 = 2 KB
  *
  * On the other hand, we don't need so much threads, so we use
- * thread_map - array of pointers to tcb_t sorted by global id and
- * ktable of tcb_t. For each search operation we use binary search.
+ * thread_map - a table indexed directly by the low bits of the TID, at
+ * least twice as large as CONFIG_MAX_THREADS, and ktable of tcb_t. TIDs are
+ * handed out densely (system threads from 0, user threads from THREAD_USER
+ * up), so a bucket rarely holds more than one TCB and lookup, insert and
+ * delete take constant time.
  *
  * Also dispatcher is responsible for switching contexts (but not
  * scheduling)
@@ -36,9 +48,28 @@
 
 DECLARE_KTABLE(tcb_t, thread_table, CONFIG_MAX_THREADS);
 
-/* Always sorted, so we can use binary search on it */
-tcb_t *thread_map[CONFIG_MAX_THREADS];
-int thread_count;
+#if CONFIG_MAX_THREADS <= 16
+#define THREAD_MAP_SIZE 32
+#elif CONFIG_MAX_THREADS <= 32
+#define THREAD_MAP_SIZE 64
+#elif CONFIG_MAX_THREADS <= 64
+#define THREAD_MAP_SIZE 128
+#elif CONFIG_MAX_THREADS <= 128
+#define THREAD_MAP_SIZE 256
+#elif CONFIG_MAX_THREADS <= 256
+#define THREAD_MAP_SIZE 512
+#else
+#define THREAD_MAP_SIZE 1024
+#endif
+
+#define THREAD_MAP_BUCKET(globalid) \
+    (&thread_map[GLOBALID_TO_TID(globalid) & (THREAD_MAP_SIZE - 1)])
+
+/* Buckets chained through tcb->t_map_next */
+static tcb_t *thread_map[THREAD_MAP_SIZE];
+
+/* Per-slot generation of thread_table, bumped on thread_deinit() */
+static uint16_t thread_gen[CONFIG_MAX_THREADS];
 
 /**
  * current are always points to TCB which was on processor before we had fallen
@@ -66,6 +97,9 @@ void thread_init_subsys()
 
     ktable_init(&thread_table);
 
+    for (int i = 0; i < CONFIG_MAX_THREADS; ++i)
+        thread_gen[i] = 1;
+
     kip.thread_info.s.system_base = THREAD_SYS;
     kip.thread_info.s.user_base = THREAD_USER;
 
@@ -94,32 +128,16 @@ INIT_HOOK(thread_init_subsys, INIT_LEVEL_KERNEL);
 extern tcb_t *caller;
 
 /*
- * Return upper_bound using binary search
+ * Find the live thread with the TID of globalid, ignoring the version
  */
-static int thread_map_search(l4_thread_t globalid, int from, int to)
+static tcb_t *thread_map_search(l4_thread_t globalid)
 {
-    int tid = GLOBALID_TO_TID(globalid);
-
-    /* Upper bound if beginning of array */
-    if (to == from || GLOBALID_TO_TID(thread_map[from]->t_globalid) >= tid)
-        return from;
-
-    while (from <= to) {
-        if ((to - from) <= 1)
-            return to;
-
-        int mid = from + (to - from) / 2;
+    tcb_t *thr = *THREAD_MAP_BUCKET(globalid);
 
-        if (GLOBALID_TO_TID(thread_map[mid]->t_globalid) > tid)
-            to = mid;
-        else if (GLOBALID_TO_TID(thread_map[mid]->t_globalid) < tid)
-            from = mid;
-        else
-            return mid;
-    }
+    while (thr && GLOBALID_TO_TID(thr->t_globalid) != GLOBALID_TO_TID(globalid))
+        thr = thr->t_map_next;
 
-    /* not reached */
-    return -1;
+    return thr;
 }
 
 /*
@@ -127,35 +145,22 @@ static int thread_map_search(l4_thread_t globalid, int from, int to)
  */
 static void thread_map_insert(l4_thread_t globalid, tcb_t *thr)
 {
-    if (thread_count == 0) {
-        thread_map[thread_count++] = thr;
-    } else {
-        int i = thread_map_search(globalid, 0, thread_count);
-        int j = thread_count;
+    tcb_t **bucket = THREAD_MAP_BUCKET(globalid);
 
-        /* Move forward
-         * Don't check if count is out of range,
-         * because we will fail on ktable_alloc
-         */
-
-        for (; j > i; --j)
-            thread_map[j] = thread_map[j - 1];
-
-        thread_map[i] = thr;
-        ++thread_count;
-    }
+    thr->t_map_next = *bucket;
+    *bucket = thr;
 }
 
-static void thread_map_delete(l4_thread_t globalid)
+static void thread_map_delete(tcb_t *thr)
 {
-    if (thread_count == 1) {
-        thread_count = 0;
-    } else {
-        int i = thread_map_search(globalid, 0, thread_count);
-        --thread_count;
-        for (; i < thread_count; i++)
-            thread_map[i] = thread_map[i + 1];
-    }
+    tcb_t **link = THREAD_MAP_BUCKET(thr->t_globalid);
+
+    while (*link && *link != thr)
+        link = &(*link)->t_map_next;
+
+    if (*link)
+        *link = thr->t_map_next;
+    thr->t_map_next = NULL;
 }
 
 /*
@@ -185,7 +190,86 @@ tcb_t *thread_init(l4_thread_t globalid, utcb_t *utcb)
     thr->utcb = utcb;
     thr->state = T_INACTIVE;
 
-    thr->timeout_event = 0;
+    thr->timeout_event.data = NULL;
+
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+    thr->ipc_direct_off = 0;
+#endif
+
+#ifdef CONFIG_CPU_ACCOUNTING
+    thr->cpu_time = 0;
+#endif
+
+#ifdef CONFIG_LATENCY_HISTOGRAM
+    thr->lat_flags = 0;
+    for (int k = 0; k < LATHIST_KINDS; ++k)
+        for (int b = 0; b < LATHIST_BUCKETS; ++b)
+            thr->lat_hist[k][b] = 0;
+#endif
+
+#ifdef CONFIG_SCHED_RR
+    thr->timeslice = CONFIG_SCHED_RR_TIMESLICE;
+    thr->quantum_left = CONFIG_SCHED_RR_TIMESLICE;
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+    thr->edf_release.data = NULL;
+    thr->edf_deadline = SCHED_EDF_NO_DEADLINE;
+    thr->edf_period = 0;
+    thr->edf_misses = 0;
+#endif
+
+#ifdef CONFIG_PERIODIC_RELEASE
+    thr->rel_event.data = NULL;
+    thr->rel_period = 0;
+    thr->rel_pending = 0;
+    thr->rel_waiting = 0;
+    thr->rel_count = 0;
+    thr->rel_missed = 0;
+    thr->rel_jitter = 0;
+    thr->rel_jitter_max = 0;
+#endif
+
+#ifdef CONFIG_SCHED_TT
+    thr->tt_windows = 0;
+#endif
+
+#ifdef CONFIG_SCHED_UPCALL
+    thr->upcall_sched = TCB_HANDLE_NONE;
+    thr->upcall_bit = 0;
+#endif
+
+#ifdef CONFIG_SCHED_BUDGET
+    thr->budget_enforce.data = NULL;
+    thr->budget_replenish.data = NULL;
+    thr->budget = 0;
+    thr->budget_period = 0;
+    thr->budget_left = 0;
+    thr->budget_nrepl = 0;
+#endif
+
+    thr->ipc_waiters = NULL;
+    thr->ipc_link.prev = NULL;
+    thr->ipc_link.next = NULL;
+    thr->ipc_wait_on = NULL;
+
+    thr->sc_donors = NULL;
+    thr->sc_next = NULL;
+    thr->sc_server = NULL;
+
+#ifdef CONFIG_KMUTEX
+    thr->kmutex_next = NULL;
+    thr->kmutex_wait = 0;
+    thr->kmutex_raised = 0;
+#endif
+
+    /* The slot may be reused: drop the previous occupant's notifications */
+    thr->ipc_notify = NULL;
+    thr->notify_bits = 0;
+    thr->notify_mask = 0;
+    thr->notify_data = 0;
+    thr->notify_depth = 0;
+    thr->notify_pending = 0;
 
     /* Initialize scheduler fields */
     thr->priority = SCHED_PRIO_DEFAULT;
@@ -206,7 +290,13 @@ tcb_t *thread_init(l4_thread_t globalid, utcb_t *utcb)
 
 void thread_deinit(tcb_t *thr)
 {
-    thread_map_delete(thr->t_globalid);
+    uint32_t idx = ktable_getid(&thread_table, (void *) thr);
+
+    /* Invalidate outstanding handles; generation 0 is reserved for none */
+    if (idx < CONFIG_MAX_THREADS && ++thread_gen[idx] == 0)
+        thread_gen[idx] = 1;
+
+    thread_map_delete(thr);
     ktable_free(&thread_table, (void *) thr);
 }
 
@@ -227,7 +317,16 @@ tcb_t *thread_create(l4_thread_t globalid, utcb_t *utcb)
         return NULL;
     }
 
+    /* TID already in use, whatever its version */
+    if (thread_map_search(globalid)) {
+        dbg_printf(DL_KDB, "THREAD_CREATE: rejected (id=%d in use)\n", id);
+        set_caller_error(UE_TC_NOT_AVAILABLE);
+        return NULL;
+    }
+
     tcb_t *thr = thread_init(globalid, utcb);
+    if (!thr)
+        return NULL;
     thr->t_parent = caller;
 
     /* Place under */
@@ -253,9 +352,41 @@ void thread_destroy(tcb_t *thr)
 {
     tcb_t *parent, *child, *prev_child;
 
+    /* Give up time-triggered windows before leaving the ready queue */
+    tt_bind(thr, 0);
+
     /* Remove from scheduler ready queue if queued */
     sched_dequeue(thr);
 
+    /* Leave the receiver's sender queue, and fail every sender still
+     * waiting for thr so none of them blocks on a dead thread.
+     */
+    ipc_wait_dequeue(thr);
+    ipc_wait_abort(thr);
+    ipc_timeout_cancel(thr);
+
+#ifdef CONFIG_SCHED_EDF
+    sched_edf_set(thr, 0);
+#endif
+    budget_set(thr, 0, 0);
+    sched_admit_remove(thr);
+    kmutex_thread_exit(thr);
+    release_thread_exit(thr);
+    upcall_thread_exit(thr);
+    lathist_thread_exit(thr);
+
+    /* Give back a scheduling context thr borrowed from, and release the
+     * callers that lent theirs to thr.
+     */
+    thread_sc_return(thr);
+    while (thr->sc_donors) {
+        tcb_t *donor = thr->sc_donors;
+
+        thr->sc_donors = donor->sc_next;
+        donor->sc_next = NULL;
+        donor->sc_server = NULL;
+    }
+
     /* remove thr from its parent and its siblings */
     parent = thr->t_parent;
 
@@ -292,11 +423,6 @@ void thread_destroy(tcb_t *thr)
     if (thr->as)
         as_put(thr->as);
 
-    /* Increment generation counter for use-after-free detection.
-     * Any code holding old generation value can detect TCB invalidation.
-     */
-    thr->notify_generation++;
-
     thread_deinit(thr);
 }
 
@@ -431,16 +557,54 @@ void thread_init_kernel_ctx(void *sp, tcb_t *thr)
 }
 
 /*
- * Search thread by its global id
+ * Search thread by its global id.
+ *
+ * Version 0 is a wildcard: it resolves to whatever thread holds the
+ * thread number, which is how the kernel names threads internally. A
+ * non-zero version must match the live thread's. Versions are chosen by
+ * the creator, not the kernel, so an ID only goes stale if its creator
+ * changes the version when it reuses the thread number; one reused with
+ * the same version resolves to the new thread.
  */
 tcb_t *thread_by_globalid(l4_thread_t globalid)
 {
-    int idx = thread_map_search(globalid, 0, thread_count);
+    tcb_t *thr = thread_map_search(globalid);
 
-    if (GLOBALID_TO_TID(thread_map[idx]->t_globalid) !=
-        GLOBALID_TO_TID(globalid))
+    /* Stale ID: the TID was reused by a thread of another version */
+    if (thr && GLOBALID_TO_VERSION(globalid) &&
+        GLOBALID_TO_VERSION(globalid) != GLOBALID_TO_VERSION(thr->t_globalid))
         return NULL;
-    return thread_map[idx];
+    return thr;
+}
+
+tcb_handle_t tcb_handle(tcb_t *thr)
+{
+    tcb_handle_t h = TCB_HANDLE_NONE;
+    uint32_t idx;
+
+    if (!thr)
+        return h;
+
+    idx = ktable_getid(&thread_table, (void *) thr);
+    if (idx >= CONFIG_MAX_THREADS)
+        return h;
+
+    h.s.index = idx;
+    h.s.gen = thread_gen[idx];
+    return h;
+}
+
+/*
+ * Resolve a handle taken by tcb_handle(). Returns NULL if the thread it
+ * referred to has been destroyed since.
+ */
+tcb_t *tcb_handle_get(tcb_handle_t h)
+{
+    if (h.s.gen == 0 || h.s.index >= CONFIG_MAX_THREADS ||
+        h.s.gen != thread_gen[h.s.index])
+        return NULL;
+
+    return (tcb_t *) thread_table.data + h.s.index;
 }
 
 int thread_isrunnable(tcb_t *thr)
@@ -466,14 +630,6 @@ void thread_switch(tcb_t *thr)
     assert((intptr_t) thr);
     assert(thread_isrunnable(thr));
 
-    /* Restore previous thread's base priority if it was boosted.
-     * This ensures IPC priority boost is temporary and only lasts
-     * for one scheduling quantum.
-     */
-    if (prev && prev->priority != prev->base_priority) {
-        sched_set_priority(prev, prev->base_priority);
-    }
-
     /* Check stack canary before switching to this thread.
      * If canary is corrupted, the thread's stack has overflowed.
      */
@@ -483,6 +639,11 @@ void thread_switch(tcb_t *thr)
               thr->stack_base ? *((uint32_t *) thr->stack_base) : 0);
     }
 
+    cputime_switch(prev);
+    budget_switch(prev, thr);
+    upcall_switch(prev, thr);
+    lathist_switch(prev, thr);
+
     current = thr;
     current_utcb = thr->utcb;
     if (current->as)
@@ -521,8 +682,11 @@ void thread_priority_inherit(tcb_t *waiter, tcb_t *holder)
         /* Set inherit_priority to waiter's priority */
         holder->inherit_priority = waiter->priority;
 
-        /* Boost holder's effective priority */
-        holder->priority = waiter->priority;
+        /* Boost holder's effective priority. sched_set_priority() moves
+         * a queued holder using its old level; a blocked holder that was
+         * only left queued lazily is dropped.
+         */
+        sched_set_priority(holder, waiter->priority);
 
         /* Recalculate preempt_threshold considering inheritance.
          * Use tighter (numerically lower) of user threshold or inherit
@@ -533,12 +697,6 @@ void thread_priority_inherit(tcb_t *waiter, tcb_t *holder)
         } else {
             holder->preempt_threshold = holder->inherit_priority;
         }
-
-        /* Requeue holder at new priority if queued */
-        if (sched_is_queued(holder)) {
-            sched_dequeue(holder);
-            sched_enqueue(holder);
-        }
     }
 
     irq_restore_flags(flags);
@@ -559,8 +717,10 @@ void thread_priority_disinherit(tcb_t *holder)
 
     flags = irq_save_flags();
 
-    /* Restore original priorities */
-    holder->priority = holder->user_priority;
+    /* Restore original priorities; base_priority is below user_priority
+     * while a CPU budget is exhausted, and donors may still hold it up.
+     */
+    thread_sc_update(holder);
     holder->inherit_priority = holder->user_priority;
 
     /* Recalculate preempt_threshold.
@@ -572,13 +732,65 @@ void thread_priority_disinherit(tcb_t *holder)
         holder->preempt_threshold = holder->inherit_priority;
     }
 
-    /* Requeue holder at original priority if queued */
-    if (sched_is_queued(holder)) {
-        sched_dequeue(holder);
-        sched_enqueue(holder);
+    irq_restore_flags(flags);
+}
+
+/**
+ * Scheduling-context donation.
+ * A thread runs at the highest of its base priority and the priorities of
+ * the callers blocked in a Call on it, so a server serves each client at
+ * that client's priority and a chain of servers at the priority of the
+ * thread at its head. Nothing changes, and no queue is touched, when the
+ * server's own priority is already at least the client's.
+ */
+void thread_sc_update(tcb_t *thr)
+{
+    for (; thr; thr = thr->sc_server) {
+        uint8_t prio = thr->base_priority;
+        tcb_t *donor;
+
+        for (donor = thr->sc_donors; donor; donor = donor->sc_next)
+            if (donor->priority < prio)
+                prio = donor->priority;
+
+        if (prio == thr->priority)
+            break;
+
+        sched_set_priority(thr, prio);
     }
+}
 
-    irq_restore_flags(flags);
+void thread_sc_donate(tcb_t *client, tcb_t *server)
+{
+    if (client == server || client->sc_server)
+        return;
+
+    client->sc_server = server;
+    client->sc_next = server->sc_donors;
+    server->sc_donors = client;
+
+    if (client->priority < server->priority)
+        thread_sc_update(server);
+}
+
+void thread_sc_return(tcb_t *client)
+{
+    tcb_t *server = client->sc_server;
+    tcb_t **link;
+
+    if (!server)
+        return;
+
+    for (link = &server->sc_donors; *link != client; link = &(*link)->sc_next)
+        ;
+    *link = client->sc_next;
+
+    client->sc_next = NULL;
+    client->sc_server = NULL;
+
+    /* Only a donor at or above the server's level can have set it */
+    if (client->priority <= server->priority)
+        thread_sc_update(server);
 }
 
 #ifdef CONFIG_KDB
@@ -606,7 +818,7 @@ void kdb_dump_threads(void)
     tcb_t *thr;
     int idx;
 
-    char *state[] = {"FREE", "RUN", "SVC", "RECV", "SEND"};
+    char *state[] = {"FREE", "RUN", "SVC", "RECV", "SEND", "NOTIFY", "MUTEX"};
 
     dbg_printf(DL_KDB, "%5s %8s %8s %6s %s\n", "type", "global", "local",
                "state", "parent");
@@ -649,4 +861,123 @@ void kdb_dump_stacks(void)
     }
 }
 
+#ifdef CONFIG_CPU_ACCOUNTING
+static tcb_t *kdb_cputime_sorted[CONFIG_MAX_THREADS];
+
+static int cmp_cputime(const void *p1, const void *p2)
+{
+    const tcb_t *t1 = *(tcb_t *const *) p1;
+    const tcb_t *t2 = *(tcb_t *const *) p2;
+
+    if (t1->cpu_time == t2->cpu_time)
+        return 0;
+    return (t1->cpu_time < t2->cpu_time) ? 1 : -1;
+}
+
+/* Share of total in tenths of a percent */
+static uint32_t kdb_cputime_permille(uint64_t part, uint64_t total)
+{
+    return total ? (uint32_t) (part * 1000 / total) : 0;
+}
+
+/* "top": threads sorted by CPU share, after the system-wide buckets */
+void kdb_show_cputime(void)
+{
+    static char *bucket_name[CPUTIME_TOTAL] = {
+        [CPUTIME_USER] = "user",
+        [CPUTIME_KERNEL] = "kernel",
+        [CPUTIME_IDLE] = "idle",
+        [CPUTIME_IRQ] = "irq",
+    };
+    uint64_t total = cputime_get(CPUTIME_TOTAL, NULL);
+    tcb_t *thr;
+    int idx, n = 0;
+
+    dbg_printf(DL_KDB, "%ld cycles accounted\n", total);
+
+    for (int i = CPUTIME_USER; i < CPUTIME_TOTAL; ++i) {
+        uint32_t pm =
+            kdb_cputime_permille(cputime_get((cputime_t) i, NULL), total);
+
+        dbg_printf(DL_KDB, "%6s %3d.%d%%\n", bucket_name[i], pm / 10, pm % 10);
+    }
+
+    for_each_in_ktable (thr, idx, (&thread_table))
+        kdb_cputime_sorted[n++] = thr;
+
+    sort(kdb_cputime_sorted, n, sizeof(kdb_cputime_sorted[0]), cmp_cputime);
+
+    dbg_printf(DL_KDB, "\n%5s %8s %16s %6s\n", "type", "global", "cycles",
+               "share");
+
+    for (idx = 0; idx < n; ++idx) {
+        uint32_t pm;
+
+        thr = kdb_cputime_sorted[idx];
+        pm = kdb_cputime_permille(thr->cpu_time, total);
+        dbg_printf(DL_KDB, "%5s %t %16ld %3d.%d%%\n", kdb_get_thread_type(thr),
+                   thr->t_globalid, thr->cpu_time, pm / 10, pm % 10);
+    }
+}
+#endif /* CONFIG_CPU_ACCOUNTING */
+
+#ifdef CONFIG_LATENCY_HISTOGRAM
+/* Latency histograms of threads with samples, one row per kind. Column b
+ * starts at 2^(b-1) us.
+ */
+void kdb_show_lathist(void)
+{
+    static char *kind_name[LATHIST_KINDS] = {
+        [LATHIST_RELEASE] = "release",
+        [LATHIST_RESPONSE] = "response",
+    };
+    tcb_t *thr;
+    int idx;
+
+    dbg_printf(DL_KDB, "%8s %8s  <1us, then from 2^(n-1) us\n", "global",
+               "kind");
+
+    for_each_in_ktable (thr, idx, (&thread_table)) {
+        for (int k = 0; k < LATHIST_KINDS; ++k) {
+            uint32_t n = 0;
+
+            for (int b = 0; b < LATHIST_BUCKETS; ++b)
+                n += thr->lat_hist[k][b];
+            if (!n)
+                continue;
+
+            dbg_printf(DL_KDB, "%t %8s ", thr->t_globalid, kind_name[k]);
+            for (int b = 0; b < LATHIST_BUCKETS; ++b)
+                dbg_printf(DL_KDB, " %d", thr->lat_hist[k][b]);
+            dbg_printf(DL_KDB, "\n");
+        }
+    }
+}
+#endif /* CONFIG_LATENCY_HISTOGRAM */
+
+#ifdef CONFIG_PERIODIC_RELEASE
+/* Periodic releases (release.h), in ktimer ticks. Jitter is how far the
+ * release event ran from its nominal tick, last and worst.
+ */
+void kdb_show_release(void)
+{
+    tcb_t *thr;
+    int idx;
+
+    dbg_printf(DL_KDB, "%8s %10s %6s %8s %6s %6s %6s\n", "global", "next",
+               "period", "releases", "missed", "jitter", "max");
+
+    for_each_in_ktable (thr, idx, (&thread_table)) {
+        if (!thr->rel_count && !thr->rel_event.data)
+            continue;
+
+        dbg_printf(DL_KDB, "%t %10d %6d %8d %6d %6d %6d\n", thr->t_globalid,
+                   thr->rel_event.data ? (uint32_t) thr->rel_event.deadline
+                                       : 0,
+                   thr->rel_period, thr->rel_count, thr->rel_missed,
+                   thr->rel_jitter, thr->rel_jitter_max);
+    }
+}
+#endif /* CONFIG_PERIODIC_RELEASE */
+
 #endif /* CONFIG_KDB */
@@ -0,0 +1,239 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <debug.h>
+#include <init_hook.h>
+#include <ktimer.h>
+#include <notification.h>
+#include <sched.h>
+#include <thread.h>
+#include <tt.h>
+#include INC_PLAT(systick.h)
+
+/* Collected by the linker from DECLARE_TT_WINDOW */
+extern tt_window_t tt_table_start[];
+extern tt_window_t tt_table_end[];
+
+#define TT_USEC_PER_TICK (1000000 / (CORE_CLOCK / CONFIG_KTIMER_HEARTBEAT))
+
+typedef struct {
+    uint32_t start; /* ticks from the frame start */
+    uint32_t end;
+    uint16_t id; /* 1-based table index, as passed to tt_bind() */
+    tcb_t *owner;
+} tt_slot_t;
+
+/* Valid windows, sorted by start */
+static tt_slot_t tt_slots[CONFIG_SCHED_TT_MAX_WINDOWS];
+static int tt_nslots;
+
+static uint32_t tt_frame; /* ticks */
+static uint64_t tt_frame_start;
+
+/* Slot the next boundary belongs to, and whether that slot is open */
+static int tt_cur;
+static int tt_open;
+
+/* Owner of the open window, NULL in slack time */
+static tcb_t *tt_active;
+
+static ktimer_event_t tt_event;
+static int tt_running;
+
+int tt_parked(tcb_t *thr)
+{
+    return thr->tt_windows && thr != tt_active;
+}
+
+static void tt_window_open(tt_slot_t *slot)
+{
+    tcb_t *owner = slot->owner;
+
+    tt_active = owner;
+    if (!owner)
+        return;
+
+    if (owner->state == T_RUNNABLE)
+        sched_enqueue(owner);
+    notification_signal(owner, SCHED_TT_RELEASE_BIT);
+    notify_wake_thread(owner);
+}
+
+static void tt_window_close(tt_slot_t *slot)
+{
+    tt_active = NULL;
+    if (slot->owner)
+        sched_dequeue(slot->owner);
+}
+
+/**
+ * Window boundary (ktimer callback, softirq context). Boundaries are kept
+ * at fixed offsets from the frame start, so a late callback does not
+ * drift the schedule; one that falls behind catches up here at once,
+ * including a window that opens where the previous one closes.
+ */
+static uint32_t tt_boundary(void *data)
+{
+    uint64_t now = ktimer_get_now();
+    uint64_t next;
+
+    for (;;) {
+        tt_slot_t *slot = &tt_slots[tt_cur];
+
+        if (tt_open) {
+            tt_window_close(slot);
+            tt_open = 0;
+            if (++tt_cur == tt_nslots) {
+                tt_cur = 0;
+                tt_frame_start += tt_frame;
+            }
+            next = tt_frame_start + tt_slots[tt_cur].start;
+        } else {
+            tt_window_open(slot);
+            tt_open = 1;
+            next = tt_frame_start + slot->end;
+        }
+
+        if (next > now)
+            return (uint32_t) (next - now);
+    }
+}
+
+/* The first frame starts at the next tick */
+static void tt_start(void)
+{
+    tt_frame_start = ktimer_get_now() + 1;
+    tt_cur = 0;
+    tt_open = 0;
+
+    if (ktimer_event_arm(&tt_event, tt_slots[0].start + 1, tt_boundary,
+                         NULL) == 0)
+        tt_running = 1;
+}
+
+static tt_slot_t *tt_lookup(uint32_t window)
+{
+    for (int i = 0; i < tt_nslots; ++i)
+        if (tt_slots[i].id == window)
+            return &tt_slots[i];
+    return NULL;
+}
+
+int tt_bindable(tcb_t *thr, uint32_t window)
+{
+    tt_slot_t *slot;
+
+    if (!window)
+        return 0;
+
+    /* A window has one owner */
+    slot = tt_lookup(window);
+    return (!slot || (slot->owner && slot->owner != thr)) ? -1 : 0;
+}
+
+int tt_bind(tcb_t *thr, uint32_t window)
+{
+    tt_slot_t *slot;
+    int i;
+
+    if (tt_bindable(thr, window) < 0)
+        return -1;
+
+    if (window) {
+        slot = tt_lookup(window);
+        if (!slot->owner) {
+            slot->owner = thr;
+            ++thr->tt_windows;
+        }
+        if (tt_open && slot == &tt_slots[tt_cur])
+            tt_active = thr;
+        if (!tt_running)
+            tt_start();
+    } else {
+        if (!thr->tt_windows)
+            return 0;
+
+        for (i = 0; i < tt_nslots; ++i)
+            if (tt_slots[i].owner == thr)
+                tt_slots[i].owner = NULL;
+        thr->tt_windows = 0;
+        if (tt_active == thr)
+            tt_active = NULL;
+    }
+
+    /* Park thr until its window opens, or put it back */
+    if (tt_parked(thr))
+        sched_dequeue(thr);
+    else if (thr->state == T_RUNNABLE)
+        sched_enqueue(thr);
+
+    return 0;
+}
+
+/*
+ * Convert the table into ticks. Windows that are empty, overrun the
+ * frame or overlap the one before are dropped with a warning.
+ */
+static void tt_init(void)
+{
+    tt_window_t *w;
+    int i, j;
+
+    tt_frame = CONFIG_SCHED_TT_MAJOR_FRAME / TT_USEC_PER_TICK;
+
+    for (w = tt_table_start; w < tt_table_end; ++w) {
+        uint32_t start = w->offset / TT_USEC_PER_TICK;
+        uint32_t end = (w->offset + w->length) / TT_USEC_PER_TICK;
+
+        if (start >= end || end > tt_frame ||
+            tt_nslots == CONFIG_SCHED_TT_MAX_WINDOWS) {
+            dbg_printf(DL_KDB, "TT: window %s dropped\n", w->name);
+            continue;
+        }
+
+        /* Insertion sort by start */
+        for (i = tt_nslots; i > 0 && tt_slots[i - 1].start > start; --i)
+            tt_slots[i] = tt_slots[i - 1];
+        tt_slots[i].start = start;
+        tt_slots[i].end = end;
+        tt_slots[i].id = w - tt_table_start + 1;
+        tt_slots[i].owner = NULL;
+        ++tt_nslots;
+    }
+
+    for (i = 1; i < tt_nslots; ++i) {
+        if (tt_slots[i].start < tt_slots[i - 1].end) {
+            dbg_printf(DL_KDB, "TT: window %s overlaps, dropped\n",
+                       tt_table_start[tt_slots[i].id - 1].name);
+            for (j = i; j < tt_nslots - 1; ++j)
+                tt_slots[j] = tt_slots[j + 1];
+            --tt_nslots;
+            --i;
+        }
+    }
+}
+
+INIT_HOOK(tt_init, INIT_LEVEL_KERNEL);
+
+#ifdef CONFIG_KDB
+void kdb_show_tt(void)
+{
+    int i;
+
+    if (!tt_nslots)
+        return;
+
+    dbg_printf(DL_KDB, "TT frame %d ticks, started %ld:\n", tt_frame,
+               tt_frame_start);
+    for (i = 0; i < tt_nslots; ++i) {
+        tt_slot_t *slot = &tt_slots[i];
+
+        dbg_printf(DL_KDB, "  %s [%d, %d) %s%t\n",
+                   tt_table_start[slot->id - 1].name, slot->start,
+                   slot->end, (tt_open && i == tt_cur) ? "open " : "",
+                   slot->owner ? slot->owner->t_globalid : 0);
+    }
+}
+#endif
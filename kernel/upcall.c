@@ -0,0 +1,112 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <debug.h>
+#include <notification.h>
+#include <thread.h>
+#include <upcall.h>
+
+extern tcb_t *kernel;
+
+/* Delegated thread last switched to: the one running, or the one the
+ * kernel thread is serving. NULL if that thread is not delegated.
+ */
+static tcb_t *upcall_watch;
+
+int upcall_valid(tcb_t *thr, l4_thread_t sched)
+{
+    tcb_t *s;
+
+    if (sched == L4_NILTHREAD)
+        return 0;
+
+    s = thread_by_globalid(sched);
+    return (!s || s == thr) ? -1 : 0;
+}
+
+int upcall_set(tcb_t *thr, l4_thread_t sched, uint32_t bit)
+{
+    tcb_t *s = NULL;
+
+    if (upcall_valid(thr, sched) < 0)
+        return -1;
+    if (sched != L4_NILTHREAD)
+        s = thread_by_globalid(sched);
+
+    /* tcb_handle(NULL) is TCB_HANDLE_NONE */
+    thr->upcall_sched = tcb_handle(s);
+    thr->upcall_bit = s ? (1UL << (bit & 31)) : 0;
+
+    if (!s && upcall_watch == thr)
+        upcall_watch = NULL;
+    return 0;
+}
+
+/* Tell thr's scheduler that thr needs a decision */
+void upcall_post(tcb_t *thr)
+{
+    tcb_t *sched;
+
+    if (!thr->upcall_bit)
+        return;
+
+    /* The handle no longer resolves once the scheduler is gone */
+    sched = tcb_handle_get(thr->upcall_sched);
+    if (!sched)
+        return;
+
+    notification_signal(sched, thr->upcall_bit);
+    notify_wake_thread(sched);
+
+    dbg_printf(DL_SCHEDULE, "UPCALL: %t -> %t\n", thr->t_globalid,
+               sched->t_globalid);
+}
+
+/* Post the watched thread's upcall if it has blocked. While the kernel
+ * thread is still running, a syscall of the watched thread may be half
+ * done, and T_SVC_BLOCKED means the same.
+ */
+static void upcall_check(tcb_t *curr)
+{
+    tcb_t *thr = upcall_watch;
+
+    if (!thr || (curr == kernel && kernel->state == T_RUNNABLE))
+        return;
+
+    if (thr->state == T_RUNNABLE || thr->state == T_SVC_BLOCKED)
+        return;
+
+    upcall_watch = NULL;
+    upcall_post(thr);
+}
+
+/* Called by schedule_select() before it picks, so that a scheduler woken
+ * here is weighed in the same decision.
+ */
+void upcall_schedule(tcb_t *curr)
+{
+    upcall_check(curr);
+}
+
+/* Called by thread_switch(). The IPC direct switch does not go through
+ * schedule_select(), so a Call from a delegated thread is seen here. The
+ * kernel thread keeps the watch on the thread it preempted.
+ */
+void upcall_switch(tcb_t *prev, tcb_t *next)
+{
+    if (next == kernel)
+        return;
+
+    upcall_check(prev);
+    upcall_watch = next->upcall_bit ? next : NULL;
+}
+
+void upcall_thread_exit(tcb_t *thr)
+{
+    if (upcall_watch == thr)
+        upcall_watch = NULL;
+    thr->upcall_sched = TCB_HANDLE_NONE;
+    thr->upcall_bit = 0;
+}
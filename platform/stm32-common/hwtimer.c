@@ -20,3 +20,27 @@ uint32_t hwtimer_now()
 {
     return *TIM2_CNT;
 }
+
+#ifdef CONFIG_KTIMER_HIRES
+void hwtimer_compare_arm(uint32_t count)
+{
+    *TIM2_CCR1 = count;
+    *TIM2_SR = ~TIMx_SR_CC1IF;
+    *TIM2_DIER |= TIMx_DIER_CC1IE;
+
+    /* The counter may have passed count while it was being written */
+    if ((int32_t) (count - *TIM2_CNT) <= 0)
+        *TIM2_EGR = TIMx_EGR_CC1G;
+}
+
+void hwtimer_compare_stop(void)
+{
+    *TIM2_DIER &= ~TIMx_DIER_CC1IE;
+}
+
+void hwtimer_compare_ack(void)
+{
+    /* rc_w0: writing 1 leaves the other flags alone */
+    *TIM2_SR = ~TIMx_SR_CC1IF;
+}
+#endif
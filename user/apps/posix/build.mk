@@ -5,4 +5,5 @@
 user-apps-posix-y = \
 	main.o \
 	test-pthread.o \
-	test-semaphore.o
+	test-semaphore.o \
+	test-timer.o
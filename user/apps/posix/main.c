@@ -9,6 +9,7 @@
  * Tests compliance with IEEE Std 1003.13-2003 PSE51 Profile:
  * - POSIX Threads (pthread_create, pthread_join, pthread_mutex_*)
  * - Semaphores (sem_init, sem_wait, sem_post)
+ * - Timers (timer_create, timer_settime, timer_getoverrun)
  * - Thread attributes and synchronization primitives
  *
  * See: https://pubs.opengroup.org/onlinepubs/9699919799/
@@ -45,6 +46,7 @@ void *posix_test_main(void *arg)
 
     run_pthread_tests();
     run_semaphore_tests();
+    run_timer_tests();
 
     printf("\n");
     printf("========================================\n");
@@ -62,6 +64,8 @@ void *posix_test_main(void *arg)
 DECLARE_USER(0,
              posix_tests,
              posix_test_main,
-             DECLARE_FPAGE(0x0,
-                           8192) /* Resource pool: stack + UTCB for threads */
+             /* Resource pool: stack + UTCB for threads, including the
+              * timer dispatchers and SIGEV_THREAD helpers
+              */
+             DECLARE_FPAGE(0x0, 12288)
              DECLARE_FPAGE(0x0, 2048)); /* Heap for thread management */
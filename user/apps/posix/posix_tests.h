@@ -57,5 +57,6 @@ extern test_context_t posix_test_ctx;
 /* Test runner declarations */
 void run_pthread_tests(void);
 void run_semaphore_tests(void);
+void run_timer_tests(void);
 
 #endif /* POSIX_TESTS_H */
@@ -15,7 +15,10 @@
 #include <l4io.h>
 #include <platform/link.h>
 #include <posix/pthread.h>
+#include <posix/sched.h>
+#include <syscall.h>
 #include <types.h>
+#include __L4_INC_ARCH(syscalls.h)
 #include "posix_tests.h"
 
 /* Test globals */
@@ -444,6 +447,70 @@ void test_pthread_mutex_timedlock(void)
     TEST_PASS();
 }
 
+/* Test 11b: PTHREAD_PRIO_PROTECT - owner runs at the ceiling */
+__USER_TEXT
+void test_pthread_mutex_prio_protect(void)
+{
+    TEST_CASE_START();
+
+#ifdef CONFIG_KMUTEX
+    pthread_mutexattr_t attr;
+    pthread_mutex_t mutex;
+    L4_Word_t base, control;
+    int ceiling = 0;
+
+    pthread_mutexattr_init(&attr);
+    ASSERT_EQUAL(pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT),
+                 ENOTSUP, "PTHREAD_PRIO_INHERIT should be unsupported");
+    ASSERT_EQUAL(pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_PROTECT),
+                 0, "setprotocol PTHREAD_PRIO_PROTECT should succeed");
+    ASSERT_EQUAL(
+        pthread_mutexattr_setprioceiling(&attr, SCHED_PRIORITY_MAX + 1),
+        EINVAL, "ceiling above SCHED_PRIORITY_MAX should fail");
+
+    /* L4 priority 6, above the test thread */
+    pthread_mutexattr_setprioceiling(&attr, SCHED_PRIORITY_MAX + 4 - 6);
+    int ret = pthread_mutex_init(&mutex, &attr);
+    ASSERT_EQUAL(ret, 0, "pthread_mutex_init with PRIO_PROTECT should succeed");
+
+    pthread_mutex_getprioceiling(&mutex, &ceiling);
+    ASSERT_EQUAL(ceiling, SCHED_PRIORITY_MAX - 2, "ceiling should read back");
+
+    L4_Schedule(L4_Myself(), ~0UL, ~0UL, ~0UL, ~0UL, &base);
+
+    ret = pthread_mutex_lock(&mutex);
+    ASSERT_EQUAL(ret, 0, "lock should succeed");
+
+    /* Any scheduling point applies the ceiling */
+    L4_Yield();
+    L4_Schedule(L4_Myself(), ~0UL, ~0UL, ~0UL, ~0UL, &control);
+    ASSERT_EQUAL(control & 0xff, 6, "owner should run at the ceiling");
+
+    ASSERT_EQUAL(pthread_mutex_trylock(&mutex), EBUSY,
+                 "trylock on a held PRIO_PROTECT mutex should fail");
+
+    pthread_mutex_unlock(&mutex);
+    L4_Schedule(L4_Myself(), ~0UL, ~0UL, ~0UL, ~0UL, &control);
+    ASSERT_EQUAL(control & 0xff, base & 0xff,
+                 "unlock should restore the base priority");
+
+    L4_Word_t stale = mutex.kmutex;
+    ASSERT_EQUAL(pthread_mutex_destroy(&mutex), 0, "destroy should succeed");
+
+    /* The slot comes back under a new generation */
+    ASSERT_EQUAL(pthread_mutex_init(&mutex, &attr), 0, "reinit should succeed");
+    ASSERT_TRUE(mutex.kmutex != stale, "reused slot should get a new handle");
+    ASSERT_TRUE(L4_KMutex(KMUTEX_DESTROY, stale, 0) != 0,
+                "stale handle should be refused");
+    ASSERT_EQUAL(pthread_mutex_destroy(&mutex), 0, "destroy should succeed");
+    pthread_mutexattr_destroy(&attr);
+
+    TEST_PASS();
+#else
+    TEST_SKIP("CONFIG_KMUTEX not set");
+#endif
+}
+
 /* Test 12: pthread_cond_timedwait - timeout */
 __USER_TEXT
 void test_pthread_cond_timedwait(void)
@@ -705,6 +772,7 @@ void run_pthread_tests(void)
     test_pthread_cond_basic();
     test_pthread_cond_broadcast();
     test_pthread_mutex_timedlock();
+    test_pthread_mutex_prio_protect();
     test_pthread_cond_timedwait();
     test_pthread_cancel();
 
@@ -0,0 +1,190 @@
+/* Copyright (c) 2026 The F9 Microkernel Project. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/**
+ * PSE51 Timer Compliance Tests
+ *
+ * Tests timer_create, timer_settime, timer_gettime, timer_getoverrun and
+ * timer_delete with SIGEV_SIGNAL, SIGEV_THREAD and SIGEV_NONE delivery.
+ */
+
+#include <l4/ipc.h>
+#include <l4io.h>
+#include <platform/link.h>
+#include <posix/signal.h>
+#include <posix/time.h>
+#include <types.h>
+#include "posix_tests.h"
+
+/* Enough to span two timer dispatchers */
+#define MANY_TIMERS 32
+
+/* Test globals - static to survive IPC register clobbering */
+__USER_BSS static timer_t test_timer;
+__USER_BSS static timer_t many_timers[MANY_TIMERS];
+__USER_BSS static struct itimerspec test_its;
+__USER_BSS static sigset_t test_set;
+__USER_BSS static int test_sig;
+__USER_BSS static int test_idx;
+__USER_BSS static int callback_count;
+__USER_BSS static int callback_value;
+
+__USER_TEXT
+static void set_its(int value_ms, int interval_ms)
+{
+    test_its.it_value.tv_sec = 0;
+    test_its.it_value.tv_nsec = value_ms * 1000000;
+    test_its.it_interval.tv_sec = 0;
+    test_its.it_interval.tv_nsec = interval_ms * 1000000;
+}
+
+__USER_TEXT
+static void timer_callback(union sigval value)
+{
+    callback_value = value.sival_int;
+    __atomic_add_fetch(&callback_count, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Test 1: one-shot SIGEV_SIGNAL timer raises its signal once */
+__USER_TEXT
+void test_timer_signal(void)
+{
+    TEST_CASE_START();
+
+    struct sigevent ev = {
+        .sigev_notify = SIGEV_SIGNAL,
+        .sigev_signo = SIGUSR1,
+    };
+    int ret = timer_create(CLOCK_MONOTONIC, &ev, &test_timer);
+    ASSERT_EQUAL(ret, 0, "timer_create should succeed");
+
+    set_its(5, 0);
+    ret = timer_settime(test_timer, 0, &test_its, NULL);
+    ASSERT_EQUAL(ret, 0, "timer_settime should succeed");
+
+    timer_gettime(test_timer, &test_its);
+    ASSERT_TRUE(test_its.it_value.tv_nsec > 0, "timer should be armed");
+
+    sigemptyset(&test_set);
+    sigaddset(&test_set, SIGUSR1);
+    ret = sigwait(&test_set, &test_sig);
+    ASSERT_EQUAL(ret, 0, "sigwait should succeed");
+    ASSERT_EQUAL(test_sig, SIGUSR1, "timer should raise SIGUSR1");
+    ASSERT_EQUAL(timer_getoverrun(test_timer), 0, "one-shot has no overrun");
+
+    timer_gettime(test_timer, &test_its);
+    ASSERT_TRUE(test_its.it_value.tv_sec == 0 && test_its.it_value.tv_nsec == 0,
+                "expired one-shot should be disarmed");
+
+    ret = timer_delete(test_timer);
+    ASSERT_EQUAL(ret, 0, "timer_delete should succeed");
+
+    TEST_PASS();
+}
+
+/* Test 2: periodic SIGEV_THREAD timer runs its callback each period */
+__USER_TEXT
+void test_timer_thread(void)
+{
+    TEST_CASE_START();
+
+    struct sigevent ev = {
+        .sigev_notify = SIGEV_THREAD,
+        .sigev_value.sival_int = 42,
+        .sigev_notify_function = timer_callback,
+    };
+    callback_count = 0;
+    int ret = timer_create(CLOCK_MONOTONIC, &ev, &test_timer);
+    ASSERT_EQUAL(ret, 0, "timer_create should succeed");
+
+    set_its(2, 2);
+    timer_settime(test_timer, 0, &test_its, NULL);
+    L4_Sleep(L4_TimePeriod(20000)); /* 20ms */
+    timer_delete(test_timer);
+
+    ASSERT_TRUE(__atomic_load_n(&callback_count, __ATOMIC_SEQ_CST) >= 3,
+                "callback should run each period");
+    ASSERT_EQUAL(callback_value, 42, "callback should get sigev_value");
+
+    TEST_PASS();
+}
+
+/* Test 3: expiries while the signal is pending count as overruns */
+__USER_TEXT
+void test_timer_overrun(void)
+{
+    TEST_CASE_START();
+
+    struct sigevent ev = {
+        .sigev_notify = SIGEV_SIGNAL,
+        .sigev_signo = SIGUSR2,
+    };
+    int ret = timer_create(CLOCK_MONOTONIC, &ev, &test_timer);
+    ASSERT_EQUAL(ret, 0, "timer_create should succeed");
+
+    set_its(1, 1);
+    timer_settime(test_timer, 0, &test_its, NULL);
+    L4_Sleep(L4_TimePeriod(10000)); /* 10ms, signal left pending */
+
+    sigemptyset(&test_set);
+    sigaddset(&test_set, SIGUSR2);
+    sigwait(&test_set, &test_sig);
+    ASSERT_TRUE(timer_getoverrun(test_timer) >= 3,
+                "pending signal should accumulate overruns");
+
+    /* Disarming stops the signal */
+    set_its(0, 0);
+    timer_settime(test_timer, 0, &test_its, NULL);
+    timer_gettime(test_timer, &test_its);
+    ASSERT_TRUE(test_its.it_value.tv_sec == 0 && test_its.it_value.tv_nsec == 0,
+                "zero it_value should disarm");
+
+    timer_delete(test_timer);
+    ASSERT_EQUAL(timer_getoverrun(test_timer), -1,
+                 "deleted timer should be invalid");
+
+    TEST_PASS();
+}
+
+/* Test 4: dozens of timers fire independently */
+__USER_TEXT
+void test_timer_many(void)
+{
+    TEST_CASE_START();
+
+    struct sigevent ev = {.sigev_notify = SIGEV_NONE};
+    int ret;
+
+    for (test_idx = 0; test_idx < MANY_TIMERS; test_idx++) {
+        ret = timer_create(CLOCK_MONOTONIC, &ev, &many_timers[test_idx]);
+        ASSERT_EQUAL(ret, 0, "timer_create should succeed");
+        set_its(2 + test_idx % 4, 0);
+        timer_settime(many_timers[test_idx], 0, &test_its, NULL);
+    }
+
+    L4_Sleep(L4_TimePeriod(20000)); /* 20ms */
+
+    for (test_idx = 0; test_idx < MANY_TIMERS; test_idx++) {
+        timer_gettime(many_timers[test_idx], &test_its);
+        ASSERT_TRUE(
+            test_its.it_value.tv_sec == 0 && test_its.it_value.tv_nsec == 0,
+            "every timer should have expired");
+        timer_delete(many_timers[test_idx]);
+    }
+
+    TEST_PASS();
+}
+
+/* Main test runner */
+__USER_TEXT
+void run_timer_tests(void)
+{
+    printf("\n=== PSE51 Timer Compliance Tests ===\n");
+
+    test_timer_signal();
+    test_timer_thread();
+    test_timer_overrun();
+    test_timer_many();
+}
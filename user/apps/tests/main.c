@@ -28,10 +28,17 @@ static void run_all_tests(void)
     test_thread_self();
     test_thread_global_id();
     test_thread_pager();
+    test_thread_lookup();
+    test_thread_stale_handle();
 
     /* Timer tests */
     test_timer_period();
     test_timer_sleep();
+    test_timer_insert_stress();
+    test_timer_kip_clock();
+    test_timer_hires();
+    test_timer_slack();
+    test_timer_periodic_release();
 
     /* KIP tests */
     test_kip_access();
@@ -40,10 +47,15 @@ static void run_all_tests(void)
     /* IPC tests (also validates thread creation via pager) */
     test_ipc_basic();
     /* TODO: test_ipc_multiword() has timing issues, needs debugging */
+    test_ipc_sender_order();
+    test_ipc_call();
+    test_ipc_switch_cycles();
+    test_ipc_string();
 
     /* Functional safety tests */
     test_ipc_timeout_send();
     test_ipc_timeout_receive();
+    test_ipc_timeout_reuse();
     test_timer_zero_sleep();
     test_timer_monotonicity();
     test_thread_priority();
@@ -55,7 +67,17 @@ static void run_all_tests(void)
     test_sched_idle_fallback();
     test_sched_round_robin();
     test_sched_no_starvation();
-    test_sched_ipc_priority_boost();
+    test_sched_ipc_donation();
+    test_sched_lazy_ipc();
+    test_sched_cpu_time();
+    test_sched_priority_range();
+    test_sched_timeslice();
+    test_sched_edf();
+    test_sched_budget();
+    test_sched_admission();
+    test_sched_time_triggered();
+    test_sched_upcall();
+    test_sched_latency();
     /* Note: test_sched_priority_order() requires more thread resources */
 
     /* Preemption-Threshold Scheduling (PTS) tests */
@@ -5,8 +5,10 @@
 
 #include <l4/ipc.h>
 #include <l4/pager.h>
+#include <l4/schedule.h>
 #include <l4/thread.h>
 #include <l4io.h>
+#include <syscall.h>
 
 #include "tests.h"
 
@@ -306,3 +308,464 @@ void test_ipc_multiword(void)
         TEST_FAIL("ipc_multiword");
     }
 }
+
+/* Sender queue ordering test state */
+#define IPC_ORDER_SENDERS 3
+__USER_BSS static L4_ThreadId_t order_receiver_tid;
+__USER_BSS static L4_ThreadId_t order_sender_tids[IPC_ORDER_SENDERS];
+__USER_BSS static volatile L4_Word_t order_from[IPC_ORDER_SENDERS];
+__USER_BSS static volatile int order_received;
+__USER_BSS static volatile int order_receiver_done;
+
+/*
+ * Receiver for sender ordering test.
+ * Sleeps until all senders are blocked, then drains them with open receives.
+ */
+__USER_TEXT
+static void *order_receiver_thread(void *arg)
+{
+    L4_MsgTag_t tag;
+    L4_ThreadId_t from;
+    int i;
+
+    L4_Sleep(L4_TimePeriod(50000)); /* 50ms: let all senders block */
+
+    for (i = 0; i < IPC_ORDER_SENDERS; i++) {
+        tag = L4_Wait_Timeout(L4_TimePeriod(100000), &from);
+        if (!L4_IpcSucceeded(tag))
+            break;
+        order_from[i] = from.raw;
+        order_received++;
+    }
+
+    order_receiver_done = 1;
+    return NULL;
+}
+
+/*
+ * Sender for ordering test: arg is the priority to block at.
+ */
+__USER_TEXT
+static void *order_sender_thread(void *arg)
+{
+    L4_Msg_t msg;
+
+    L4_Set_Priority(L4_Myself(), (L4_Word_t) arg);
+
+    L4_MsgClear(&msg);
+    L4_MsgAppendWord(&msg, (L4_Word_t) arg);
+    L4_MsgLoad(&msg);
+
+    L4_Send_Timeout(order_receiver_tid, L4_TimePeriod(200000));
+    return NULL;
+}
+
+/*
+ * Test: open receive picks blocked senders by priority, then FIFO.
+ * Senders block in order A(20), B(12), C(20); expected order is B, A, C.
+ */
+__USER_TEXT
+void test_ipc_sender_order(void)
+{
+    int timeout;
+    int i;
+    int ok;
+
+    TEST_RUN("ipc_sender_order");
+
+    order_received = 0;
+    order_receiver_done = 0;
+    for (i = 0; i < IPC_ORDER_SENDERS; i++)
+        order_from[i] = 0;
+
+    order_receiver_tid = pager_create_thread();
+    if (order_receiver_tid.raw == 0) {
+        printf("Failed to create order receiver\n");
+        TEST_FAIL("ipc_sender_order");
+        return;
+    }
+
+    for (i = 0; i < IPC_ORDER_SENDERS; i++) {
+        order_sender_tids[i] = pager_create_thread();
+        if (order_sender_tids[i].raw == 0) {
+            printf("Failed to create order sender %d\n", i);
+            TEST_FAIL("ipc_sender_order");
+            return;
+        }
+    }
+
+    pager_start_thread(order_receiver_tid, order_receiver_thread, NULL);
+
+    /* Start senders one at a time so they block in a known order */
+    for (i = 0; i < IPC_ORDER_SENDERS; i++) {
+        L4_Word_t prio = (i == 1) ? 12 : 20;
+
+        pager_start_thread(order_sender_tids[i], order_sender_thread,
+                           (void *) prio);
+        L4_Sleep(L4_TimePeriod(5000)); /* 5ms */
+    }
+
+    timeout = 50;
+    while (!order_receiver_done && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(10000));
+        timeout--;
+    }
+
+    ok = order_receiver_done && order_received == IPC_ORDER_SENDERS &&
+         order_from[0] == order_sender_tids[1].raw &&
+         order_from[1] == order_sender_tids[0].raw &&
+         order_from[2] == order_sender_tids[2].raw;
+
+    if (ok) {
+        TEST_PASS("ipc_sender_order");
+    } else {
+        printf("Sender order wrong: got %d msgs\n", order_received);
+        for (i = 0; i < order_received; i++)
+            printf("  [%d] from=0x%lx\n", i, (unsigned long) order_from[i]);
+        TEST_FAIL("ipc_sender_order");
+    }
+}
+
+/* Call/ReplyWait round-trip test state */
+#define IPC_CALL_ROUNDS 8
+__USER_BSS static L4_ThreadId_t call_server_tid;
+__USER_BSS static volatile int call_server_ready;
+__USER_BSS static volatile int call_server_served;
+
+/*
+ * Echo server: replies to each request with its first word plus one,
+ * using ReplyWait so reply and next receive share one trap.
+ */
+__USER_TEXT
+static void *call_server_thread(void *arg)
+{
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    L4_ThreadId_t from;
+    L4_Word_t word;
+    int i;
+
+    call_server_ready = 1;
+    tag = L4_Wait_Timeout(L4_TimePeriod(500000), &from);
+
+    for (i = 0; i < IPC_CALL_ROUNDS; i++) {
+        if (!L4_IpcSucceeded(tag))
+            break;
+
+        L4_MsgStore(tag, &msg);
+        word = L4_MsgWord(&msg, 0);
+
+        L4_MsgClear(&msg);
+        L4_MsgAppendWord(&msg, word + 1);
+        L4_MsgLoad(&msg);
+        call_server_served++;
+
+        if (i == IPC_CALL_ROUNDS - 1) {
+            L4_Reply(from);
+            break;
+        }
+        tag = L4_ReplyWait(from, &from);
+    }
+
+    return NULL;
+}
+
+/*
+ * Test: L4_Call round-trips against a ReplyWait server.
+ * Exercises the combined send+receive IPC path in both directions.
+ */
+__USER_TEXT
+void test_ipc_call(void)
+{
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    int timeout;
+    int i;
+
+    TEST_RUN("ipc_call");
+
+    call_server_ready = 0;
+    call_server_served = 0;
+
+    call_server_tid = pager_create_thread();
+    if (call_server_tid.raw == 0) {
+        printf("Failed to create call server\n");
+        TEST_FAIL("ipc_call");
+        return;
+    }
+    pager_start_thread(call_server_tid, call_server_thread, NULL);
+
+    timeout = 100;
+    while (!call_server_ready && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+    L4_Sleep(L4_TimePeriod(1000)); /* let server block in receive */
+
+    for (i = 0; i < IPC_CALL_ROUNDS; i++) {
+        L4_MsgClear(&msg);
+        L4_MsgAppendWord(&msg, 0x100 + i);
+        L4_MsgLoad(&msg);
+
+        tag = L4_Call(call_server_tid);
+        if (!L4_IpcSucceeded(tag))
+            break;
+
+        L4_MsgStore(tag, &msg);
+        if (L4_MsgWord(&msg, 0) != 0x100 + i + 1)
+            break;
+    }
+
+    if (i == IPC_CALL_ROUNDS && call_server_served == IPC_CALL_ROUNDS) {
+        TEST_PASS("ipc_call");
+    } else {
+        printf("Call round-trip failed at %d (served %d)\n", i,
+               call_server_served);
+        TEST_FAIL("ipc_call");
+    }
+}
+
+#if defined(CONFIG_CPU_ACCOUNTING) && defined(CONFIG_IPC_DIRECT_SWITCH)
+/* IPC switch cost comparison state */
+#define IPC_SWITCH_ROUNDS 1000
+__USER_BSS static L4_ThreadId_t switch_server_tid;
+__USER_BSS static volatile int switch_server_ready;
+
+/*
+ * Server for switch cost test: answers every Call with ReplyWait (one
+ * trap, fastpath) for two measured loops.
+ */
+__USER_TEXT
+static void *switch_server_thread(void *arg)
+{
+    L4_MsgTag_t tag;
+    L4_ThreadId_t from;
+    int i;
+
+    switch_server_ready = 1;
+    tag = L4_Wait(&from);
+
+    for (i = 0; i < 2 * IPC_SWITCH_ROUNDS; i++) {
+        if (!L4_IpcSucceeded(tag))
+            break;
+
+        L4_LoadMR(0, 0);
+        if (i == 2 * IPC_SWITCH_ROUNDS - 1) {
+            L4_Send(from); /* client may not have entered receive yet */
+            break;
+        }
+        tag = L4_ReplyWait(from, &from);
+    }
+
+    return NULL;
+}
+
+/*
+ * Run IPC_SWITCH_ROUNDS Call round-trips with the direct switch turned on
+ * or off for both ends; return cycles per round-trip, 0 on failure.
+ */
+__USER_TEXT
+static L4_Word_t switch_measure(int direct)
+{
+    L4_Word64_t start, end;
+    L4_MsgTag_t tag;
+    int i;
+
+    L4_Set_DirectSwitch(L4_Myself(), direct);
+    L4_Set_DirectSwitch(switch_server_tid, direct);
+    start = L4_CpuTime(CPUTIME_TOTAL, L4_nilthread);
+
+    for (i = 0; i < IPC_SWITCH_ROUNDS; i++) {
+        L4_LoadMR(0, 0);
+        tag = L4_Call(switch_server_tid);
+        if (!L4_IpcSucceeded(tag))
+            return 0;
+    }
+
+    end = L4_CpuTime(CPUTIME_TOTAL, L4_nilthread);
+    return (L4_Word_t) ((end - start) / IPC_SWITCH_ROUNDS);
+}
+#endif
+
+/*
+ * Test: cycle cost of the same Call/ReplyWait round-trip with the IPC
+ * direct process switch on and off. Off, the fastpath switches through
+ * PendSV like the slowpath.
+ */
+__USER_TEXT
+void test_ipc_switch_cycles(void)
+{
+#if defined(CONFIG_CPU_ACCOUNTING) && defined(CONFIG_IPC_DIRECT_SWITCH)
+    L4_Word_t direct_cyc, pendsv_cyc;
+    int timeout;
+
+    TEST_RUN("ipc_switch_cycles");
+
+    switch_server_ready = 0;
+
+    switch_server_tid = pager_create_thread();
+    if (switch_server_tid.raw == 0) {
+        printf("Failed to create switch server\n");
+        TEST_FAIL("ipc_switch_cycles");
+        return;
+    }
+    pager_start_thread(switch_server_tid, switch_server_thread, NULL);
+
+    timeout = 100;
+    while (!switch_server_ready && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+    L4_Sleep(L4_TimePeriod(1000)); /* let server block in receive */
+
+    pendsv_cyc = switch_measure(0);
+    direct_cyc = switch_measure(1);
+
+    printf("IPC round-trip: direct switch %lu cyc, PendSV %lu cyc\n",
+           (unsigned long) direct_cyc, (unsigned long) pendsv_cyc);
+
+    if (!direct_cyc || !pendsv_cyc) {
+        TEST_FAIL("ipc_switch_cycles");
+        return;
+    }
+
+#ifdef CONFIG_HAS_PRECISE_TIMING
+    TEST_ASSERT("ipc_switch_cycles", direct_cyc <= pendsv_cyc);
+#else
+    /* Emulated timing is not cycle accurate, only report the numbers */
+    TEST_PASS("ipc_switch_cycles");
+#endif
+#elif defined(CONFIG_CPU_ACCOUNTING)
+    test_skip("ipc_switch_cycles", "CONFIG_IPC_DIRECT_SWITCH not set");
+#else
+    test_skip("ipc_switch_cycles", "CONFIG_CPU_ACCOUNTING not set");
+#endif
+}
+
+/* StringItem transfer state */
+#define IPC_STRING_LEN 1024
+#define IPC_STRING_RCV_LEN 1536
+__USER_BSS static L4_ThreadId_t string_server_tid;
+__USER_BSS static volatile int string_server_ready;
+__USER_BSS static volatile int string_server_errors;
+__USER_BSS static L4_Word_t string_snd[2048 / sizeof(L4_Word_t)];
+__USER_BSS static L4_Word_t string_rcv[IPC_STRING_RCV_LEN / sizeof(L4_Word_t)];
+
+/*
+ * Server for StringItem test. Accepts one simple string into string_rcv
+ * per message and replies with the received length and a checksum.
+ */
+__USER_TEXT
+static void *string_server_thread(void *arg)
+{
+    L4_MsgBuffer_t buf;
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    L4_ThreadId_t from;
+    L4_Word_t len, sum;
+    int i, n;
+
+    for (n = 0; n < 2; n++) {
+        L4_MsgBufferClear(&buf);
+        L4_MsgBufferAppendSimpleRcvString(
+            &buf, L4_StringItem(IPC_STRING_RCV_LEN, string_rcv));
+        L4_AcceptStrings(L4_StringItemsAcceptor, &buf);
+
+        string_server_ready = 1;
+        tag = L4_Wait(&from);
+        if (!L4_IpcSucceeded(tag)) {
+            string_server_errors++;
+            continue;
+        }
+
+        /* MR1: string item with received length, MR2: buffer address */
+        L4_MsgStore(tag, &msg);
+        len = L4_MsgWord(&msg, 0) >> 10;
+        sum = 0;
+        for (i = 0; i < len / sizeof(L4_Word_t); i++)
+            sum += string_rcv[i];
+
+        L4_MsgClear(&msg);
+        L4_MsgAppendWord(&msg, len);
+        L4_MsgAppendWord(&msg, sum);
+        L4_MsgLoad(&msg);
+        L4_Send(from);
+    }
+
+    return NULL;
+}
+
+/*
+ * Test: StringItem transfer into an accepted receive buffer, and
+ * overflow rejection when the string exceeds the buffer.
+ */
+__USER_TEXT
+void test_ipc_string(void)
+{
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    L4_Word_t sum, error;
+    int timeout;
+    int i;
+
+    TEST_RUN("ipc_string");
+
+    string_server_ready = 0;
+    string_server_errors = 0;
+
+    sum = 0;
+    for (i = 0; i < IPC_STRING_LEN / sizeof(L4_Word_t); i++) {
+        string_snd[i] = 0x5A000000 + i;
+        sum += string_snd[i];
+    }
+
+    string_server_tid = pager_create_thread();
+    if (string_server_tid.raw == 0) {
+        printf("Failed to create string server\n");
+        TEST_FAIL("ipc_string");
+        return;
+    }
+    pager_start_thread(string_server_tid, string_server_thread, NULL);
+
+    timeout = 100;
+    while (!string_server_ready && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+    L4_Sleep(L4_TimePeriod(1000)); /* let server block in receive */
+
+    L4_MsgClear(&msg);
+    L4_MsgAppendSimpleStringItem(&msg,
+                                 L4_StringItem(IPC_STRING_LEN, string_snd));
+    L4_MsgLoad(&msg);
+
+    tag = L4_Call(string_server_tid);
+    if (!L4_IpcSucceeded(tag)) {
+        printf("String call failed: error %p\n", L4_ErrorCode());
+        TEST_FAIL("ipc_string");
+        return;
+    }
+
+    L4_MsgStore(tag, &msg);
+    if (L4_MsgWord(&msg, 0) != IPC_STRING_LEN || L4_MsgWord(&msg, 1) != sum) {
+        printf("String mismatch: len %d sum %p (expected %d %p)\n",
+               L4_MsgWord(&msg, 0), L4_MsgWord(&msg, 1), IPC_STRING_LEN, sum);
+        TEST_FAIL("ipc_string");
+        return;
+    }
+
+    L4_Sleep(L4_TimePeriod(1000)); /* let server re-arm its buffer */
+
+    /* Larger than the receive buffer: both sides see message overflow */
+    L4_MsgClear(&msg);
+    L4_MsgAppendSimpleStringItem(&msg,
+                                 L4_StringItem(sizeof(string_snd), string_snd));
+    L4_MsgLoad(&msg);
+
+    tag = L4_Send(string_server_tid);
+    error = L4_ErrorCode();
+    L4_Sleep(L4_TimePeriod(1000)); /* let server see its error */
+
+    TEST_ASSERT("ipc_string", L4_IpcFailed(tag) && ((error >> 1) & 7) == 4 &&
+                                  string_server_errors == 1);
+}
@@ -92,6 +92,97 @@ void test_ipc_timeout_receive(void)
     }
 }
 
+/* Timed IPC round trips, well past the size of the ktimer event pool */
+#define IPC_TIMEOUT_ROUNDS (2 * CONFIG_MAX_KT_EVENTS)
+#define IPC_TIMEOUT_NOTIFY_BIT (1 << 9)
+__USER_BSS static L4_ThreadId_t timeout_server_tid;
+__USER_BSS static volatile int timeout_server_ready;
+
+__USER_TEXT
+static void *timeout_server_thread(void *arg)
+{
+    L4_MsgTag_t tag;
+    L4_ThreadId_t from;
+    int i;
+
+    timeout_server_ready = 1;
+
+    for (i = 0; i < IPC_TIMEOUT_ROUNDS; i++) {
+        tag = L4_Wait_Timeout(L4_TimePeriod(1000000), &from);
+        if (!L4_IpcSucceeded(tag))
+            break;
+
+        L4_LoadMR(0, 0);
+        L4_Send_Timeout(from, L4_TimePeriod(1000000));
+    }
+
+    return NULL;
+}
+
+/*
+ * IPC Timeout Reuse Test
+ *
+ * Each round blocks with a 1s timeout and completes at once. The timeouts
+ * live in the TCBs and are cancelled on completion, so the rounds neither
+ * exhaust the ktimer event pool nor leave timeouts behind to fire: a
+ * timer can still be armed afterwards, and a short timed receive still
+ * times out on schedule.
+ */
+__USER_TEXT
+void test_ipc_timeout_reuse(void)
+{
+    L4_MsgTag_t tag;
+    L4_ThreadId_t from;
+    L4_Clock_t start, end;
+    L4_Word_t timer, bits;
+    int i, timeout;
+
+    TEST_RUN("ipc_timeout_reuse");
+
+    timeout_server_ready = 0;
+    timeout_server_tid = pager_create_thread();
+    if (timeout_server_tid.raw == 0) {
+        printf("Failed to create timeout server\n");
+        TEST_FAIL("ipc_timeout_reuse");
+        return;
+    }
+    pager_start_thread(timeout_server_tid, timeout_server_thread, NULL);
+
+    timeout = 100;
+    while (!timeout_server_ready && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+
+    for (i = 0; i < IPC_TIMEOUT_ROUNDS; i++) {
+        L4_LoadMR(0, 0);
+        tag = L4_Call_Timeouts(timeout_server_tid, L4_TimePeriod(1000000),
+                               L4_TimePeriod(1000000));
+        if (!L4_IpcSucceeded(tag))
+            break;
+    }
+
+    L4_NotifyClear(IPC_TIMEOUT_NOTIFY_BIT);
+    timer = L4_TimerNotify(10, IPC_TIMEOUT_NOTIFY_BIT, 0);
+    L4_Sleep(L4_TimePeriod(20000));
+    bits = L4_NotifyClear(IPC_TIMEOUT_NOTIFY_BIT);
+
+    start = L4_SystemClock();
+    tag = L4_Wait_Timeout(L4_TimePeriod(5000), &from);
+    end = L4_SystemClock();
+
+    if (i != IPC_TIMEOUT_ROUNDS)
+        printf("Timed round trip failed at %d\n", i);
+    if (!timer)
+        printf("Timer pool exhausted after timed IPC\n");
+
+    TEST_ASSERT("ipc_timeout_reuse",
+                i == IPC_TIMEOUT_ROUNDS && timer &&
+                    bits == IPC_TIMEOUT_NOTIFY_BIT && L4_IpcFailed(tag) &&
+                    (end.raw - start.raw) >= 4000 &&
+                    (end.raw - start.raw) < 100000);
+}
+
 /*
  * NOTE: test_ipc_bad_destination was removed because sending to
  * L4_nilthread with L4_ZeroTime causes undefined blocking behavior.
@@ -20,7 +20,8 @@
  *   S3: Message ordering - queue messages preserve FIFO order
  *   S4: Mutual exclusion - mutexes ensure critical section safety
  *   S5: Lock release - taken locks are eventually released
- *   S6: Priority inheritance - temporary boost during IPC, restoration after
+ *   S6: Priority inheritance - Calls donate the client's priority, returned
+ *       on reply
  *
  * LIVENESS PROPERTY:
  *   All tasks finish jobs infinitely often (no starvation)
@@ -46,6 +47,7 @@
 #include <l4/schedule.h>
 #include <l4/thread.h>
 #include <l4io.h>
+#include <syscall.h>
 #include <user_runtime.h>
 
 #include "tests.h"
@@ -193,35 +195,134 @@ void test_sched_idle_fallback(void)
     TEST_PASS("sched_idle_fallback");
 }
 
+/* Scheduling-context donation state */
+#define SCHED_DON_CLIENT_PRIO 12
+#define SCHED_DON_PRIO_A 26
+#define SCHED_DON_PRIO_B 28
+__USER_BSS static L4_ThreadId_t don_srv_tid[2];
+__USER_BSS static volatile int don_srv_ready[2];
+__USER_BSS static volatile L4_Word_t don_srv_after[2];
+
+__USER_TEXT
+static L4_Word_t sched_my_priority(void)
+{
+    L4_Word_t control;
+
+    L4_Schedule(L4_Myself(), ~0UL, ~0UL, ~0UL, ~0UL, &control);
+    return control & 0xff;
+}
+
 /*
- * Test: IPC Priority Boost (S6 - Priority Inheritance)
+ * Server at priority 26 (arg 0) or 28 (arg 1). Serves one Call, in
+ * which server 0 calls on to server 1, and answers with the priority it
+ * ran at in each server on the way. Afterwards it records the priority
+ * it is back at.
+ */
+__USER_TEXT
+static void *don_server_thread(void *arg)
+{
+    int idx = (int) arg;
+    L4_ThreadId_t from;
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    L4_Word_t mine, onward = 0;
+
+    L4_Set_Priority(L4_Myself(), idx ? SCHED_DON_PRIO_B : SCHED_DON_PRIO_A);
+    don_srv_ready[idx] = 1;
+
+    tag = L4_Wait(&from);
+    if (!L4_IpcSucceeded(tag))
+        return NULL;
+
+    mine = sched_my_priority();
+    if (!idx) {
+        L4_MsgClear(&msg);
+        L4_MsgLoad(&msg);
+        tag = L4_Call(don_srv_tid[1]);
+        L4_MsgStore(tag, &msg);
+        if (L4_IpcSucceeded(tag))
+            onward = L4_MsgWord(&msg, 0);
+    }
+
+    L4_MsgClear(&msg);
+    L4_MsgAppendWord(&msg, mine);
+    L4_MsgAppendWord(&msg, onward);
+    L4_MsgLoad(&msg);
+    L4_Reply(from);
+
+    don_srv_after[idx] = sched_my_priority();
+    return NULL;
+}
+
+/*
+ * Test: Scheduling-Context Donation (S6 - Priority Inheritance)
  *
  * From the paper's property S6:
  *   "A low-priority task must inherit priorities when its mutex was
  *   taken by tasks with higher priorities and recover its priority
  *   after releasing the mutex."
  *
- * F9 implements this at kernel level during IPC:
- *   - Boost: thread->priority = caller->priority (kernel/ipc.c)
- *   - Restore: sched_set_priority(prev, prev->base_priority) (thread.c)
- *
- * The test_ipc_basic test validates IPC works end-to-end, which
- * implicitly validates priority boost. This test confirms the
- * underlying yield mechanism supports priority changes.
+ * An IPC Call lends the caller's priority to the server until the reply
+ * (thread_sc_donate() in kernel/thread.c), and a server calling onward
+ * passes it down the chain. A client at priority 12 calls a server at 26
+ * which calls one at 28: both must serve at 12 and fall back to their
+ * own priorities once they have replied.
  */
 __USER_TEXT
-void test_sched_ipc_priority_boost(void)
+void test_sched_ipc_donation(void)
 {
-    TEST_RUN("sched_ipc_priority_boost");
+    L4_Word_t old_prio = sched_my_priority();
+    L4_Word_t prio_a = 0, prio_b = 0;
+    L4_MsgTag_t tag;
+    L4_Msg_t msg;
+    int timeout;
+    int i;
 
-    /*
-     * F9's priority boost is kernel-internal (not exposed via syscall).
-     * Validate the scheduler handles priority changes correctly by
-     * confirming yield works after IPC-like operations.
-     */
-    L4_Yield();
+    TEST_RUN("sched_ipc_donation");
+
+    for (i = 0; i < 2; i++) {
+        don_srv_ready[i] = 0;
+        don_srv_after[i] = 0;
+        don_srv_tid[i] = pager_create_thread();
+        if (don_srv_tid[i].raw == 0) {
+            printf("Failed to create server %d\n", i);
+            TEST_FAIL("sched_ipc_donation");
+            return;
+        }
+        pager_start_thread(don_srv_tid[i], don_server_thread, (void *) i);
+    }
+
+    timeout = 100;
+    while (!(don_srv_ready[0] && don_srv_ready[1]) && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+    L4_Sleep(L4_TimePeriod(1000)); /* let both servers block in receive */
+
+    L4_Set_Priority(L4_Myself(), SCHED_DON_CLIENT_PRIO);
+
+    L4_MsgClear(&msg);
+    L4_MsgLoad(&msg);
+    tag = L4_Call(don_srv_tid[0]);
+    L4_MsgStore(tag, &msg);
+    if (L4_IpcSucceeded(tag)) {
+        prio_a = L4_MsgWord(&msg, 0);
+        prio_b = L4_MsgWord(&msg, 1);
+    }
+
+    L4_Set_Priority(L4_Myself(), old_prio);
+    L4_Sleep(L4_TimePeriod(5000)); /* let the servers record and exit */
+
+    printf("Donation: served at %lu/%lu, back at %lu/%lu\n",
+           (unsigned long) prio_a, (unsigned long) prio_b,
+           (unsigned long) don_srv_after[0],
+           (unsigned long) don_srv_after[1]);
 
-    TEST_PASS("sched_ipc_priority_boost");
+    TEST_ASSERT("sched_ipc_donation",
+                prio_a == SCHED_DON_CLIENT_PRIO &&
+                    prio_b == SCHED_DON_CLIENT_PRIO &&
+                    don_srv_after[0] == SCHED_DON_PRIO_A &&
+                    don_srv_after[1] == SCHED_DON_PRIO_B);
 }
 
 /*
@@ -250,6 +351,840 @@ void test_sched_syscall(void)
     }
 }
 
+/* Lazy queueing ping-pong state */
+#define SCHED_LAZY_ROUNDS 500
+__USER_BSS static L4_ThreadId_t lazy_peer_tid;
+__USER_BSS static volatile int lazy_peer_ready;
+__USER_BSS static volatile int lazy_peer_served;
+
+/*
+ * Peer for the lazy queueing test. Separate Send and Receive keep every
+ * round on the slowpath, so each IPC blocks and wakes both threads
+ * through the ready queues.
+ */
+__USER_TEXT
+static void *lazy_peer_thread(void *arg)
+{
+    L4_MsgTag_t tag;
+    L4_ThreadId_t from;
+    int i;
+
+    lazy_peer_ready = 1;
+    tag = L4_Wait(&from);
+
+    for (i = 0; i < SCHED_LAZY_ROUNDS; i++) {
+        if (!L4_IpcSucceeded(tag))
+            break;
+        lazy_peer_served++;
+
+        L4_LoadMR(0, 0);
+        L4_Send(from);
+        if (i == SCHED_LAZY_ROUNDS - 1)
+            break;
+        tag = L4_Receive(from);
+    }
+
+    return NULL;
+}
+
+/*
+ * Test: Lazy Queueing Under IPC Churn
+ *
+ * A blocked thread stays in its ready queue until schedule_select()
+ * reaches it, so a thread that blocks and is woken again before that
+ * costs no queue work. Ping-pong between two threads of equal priority
+ * must still deliver every message and never select a blocked thread
+ * (which would fault on a stale context). With CONFIG_KDB, the queue
+ * critical sections per IPC are reported and must stay below the two
+ * (unlink on block, link on wake) that eager queueing costs.
+ */
+__USER_TEXT
+void test_sched_lazy_ipc(void)
+{
+    L4_Clock_t start, end;
+    L4_MsgTag_t tag;
+    int timeout;
+    int i;
+#ifdef CONFIG_KDB
+    L4_Word_t crit;
+#endif
+
+    TEST_RUN("sched_lazy_ipc");
+
+    lazy_peer_ready = 0;
+    lazy_peer_served = 0;
+
+    lazy_peer_tid = pager_create_thread();
+    if (lazy_peer_tid.raw == 0) {
+        printf("Failed to create peer thread\n");
+        TEST_FAIL("sched_lazy_ipc");
+        return;
+    }
+    pager_start_thread(lazy_peer_tid, lazy_peer_thread, NULL);
+
+    timeout = 100;
+    while (!lazy_peer_ready && timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        timeout--;
+    }
+    L4_Sleep(L4_TimePeriod(1000)); /* let peer block in receive */
+
+#ifdef CONFIG_KDB
+    crit = L4_SchedStat(SCHEDSTAT_CRIT);
+#endif
+    start = L4_SystemClock();
+    for (i = 0; i < SCHED_LAZY_ROUNDS; i++) {
+        L4_LoadMR(0, 0);
+        L4_Send(lazy_peer_tid);
+        tag = L4_Receive(lazy_peer_tid);
+        if (!L4_IpcSucceeded(tag))
+            break;
+    }
+    end = L4_SystemClock();
+#ifdef CONFIG_KDB
+    crit = L4_SchedStat(SCHEDSTAT_CRIT) - crit;
+#endif
+
+    printf("Slowpath round-trip: %lu us per %d rounds\n",
+           (unsigned long) (end.raw - start.raw), SCHED_LAZY_ROUNDS);
+
+    if (i != SCHED_LAZY_ROUNDS || lazy_peer_served != SCHED_LAZY_ROUNDS) {
+        printf("Ping-pong stopped at %d (served %d)\n", i, lazy_peer_served);
+        TEST_FAIL("sched_lazy_ipc");
+        return;
+    }
+
+#ifdef CONFIG_KDB
+    /* Two IPCs per round */
+    printf("Queue critical sections: %lu.%02lu per IPC\n",
+           (unsigned long) (crit / (2 * SCHED_LAZY_ROUNDS)),
+           (unsigned long) (crit * 100 / (2 * SCHED_LAZY_ROUNDS) % 100));
+    TEST_ASSERT("sched_lazy_ipc", crit < 2 * 2 * SCHED_LAZY_ROUNDS);
+#else
+    TEST_PASS("sched_lazy_ipc");
+#endif
+}
+
+#define SCHED_CPU_SPIN_US 20000
+
+/*
+ * Test: Per-thread CPU Time Accounting
+ *
+ * Spinning for 20ms must be charged to this thread (at least half of it;
+ * IRQs and preemption take the rest). Sleeping for 20ms must not be: the
+ * thread gains at most a few ms while the system total keeps growing.
+ */
+__USER_TEXT
+void test_sched_cpu_time(void)
+{
+#ifdef CONFIG_CPU_ACCOUNTING
+    L4_Word64_t t0, t1, t2, total0, total2;
+    L4_Clock_t start;
+    uint32_t spun, slept;
+
+    TEST_RUN("sched_cpu_time");
+
+    total0 = L4_CpuTime(CPUTIME_TOTAL, L4_nilthread);
+    t0 = L4_CpuTime(CPUTIME_THREAD, L4_nilthread);
+
+    start = L4_SystemClock();
+    while (L4_SystemClock().raw - start.raw < SCHED_CPU_SPIN_US)
+        ;
+
+    t1 = L4_CpuTime(CPUTIME_THREAD, L4_nilthread);
+    L4_Sleep(L4_TimePeriod(SCHED_CPU_SPIN_US));
+    t2 = L4_CpuTime(CPUTIME_THREAD, L4_nilthread);
+    total2 = L4_CpuTime(CPUTIME_TOTAL, L4_nilthread);
+
+    spun = (uint32_t) (t1 - t0) / TEST_CYCLES_PER_USEC;
+    slept = (uint32_t) (t2 - t1) / TEST_CYCLES_PER_USEC;
+    printf("CPU time: spin %lu us, sleep %lu us of %d us\n",
+           (unsigned long) spun, (unsigned long) slept, SCHED_CPU_SPIN_US);
+
+    TEST_ASSERT("sched_cpu_time",
+                spun >= SCHED_CPU_SPIN_US / 2 &&
+                    slept < SCHED_CPU_SPIN_US / 4 &&
+                    total2 - total0 >= t2 - t0);
+#else
+    test_skip("sched_cpu_time", "CONFIG_CPU_ACCOUNTING not set");
+#endif
+}
+
+#ifdef CONFIG_SCHED_PRIO_256
+#define SCHED_LOWEST_USER_PRIO 254
+#else
+#define SCHED_LOWEST_USER_PRIO 30
+#endif
+
+/*
+ * Test: Full Priority Range
+ *
+ * Every level up to the one above idle must be settable, and the
+ * scheduler must still pick this thread there: with CONFIG_SCHED_PRIO_256
+ * that level sits in the last bitmap group, past the summary word's
+ * first bit.
+ */
+__USER_TEXT
+void test_sched_priority_range(void)
+{
+    L4_ThreadId_t self = L4_Myself();
+    L4_Word_t old_control, control;
+
+    TEST_RUN("sched_priority_range");
+
+    L4_Schedule(self, ~0UL, ~0UL, ~0UL, ~0UL, &old_control);
+    L4_Set_Priority(self, SCHED_LOWEST_USER_PRIO);
+    L4_Yield(); /* must come back from the lowest user level */
+    L4_Schedule(self, ~0UL, ~0UL, ~0UL, ~0UL, &control);
+    L4_Set_Priority(self, old_control & 0xff);
+
+    TEST_ASSERT("sched_priority_range",
+                (control & 0xff) == SCHED_LOWEST_USER_PRIO);
+}
+
+#ifdef CONFIG_SCHED_RR
+#define SCHED_RR_SPIN_US 100000
+
+__USER_BSS static volatile uint32_t rr_count[2];
+__USER_BSS static volatile uint32_t rr_seen[2];
+__USER_BSS static volatile int rr_done[2];
+
+/*
+ * CPU-bound thread at priority 20 with a 5ms timeslice. Spins for 100ms
+ * of wall clock, then records how far its sibling got meanwhile.
+ */
+__USER_TEXT
+static void *rr_spinner_thread(void *arg)
+{
+    int idx = (int) arg;
+    L4_Clock_t start;
+
+    L4_Set_Priority(L4_Myself(), 20);
+    L4_Set_Timeslice(L4_Myself(), L4_TimePeriod(5000), L4_Never);
+
+    start = L4_SystemClock();
+    while (L4_SystemClock().raw - start.raw < SCHED_RR_SPIN_US)
+        rr_count[idx]++;
+
+    rr_seen[idx] = rr_count[1 - idx];
+    rr_done[idx] = 1;
+    return NULL;
+}
+#endif
+
+/*
+ * Test: Round-Robin Timeslice Preemption
+ *
+ * Two CPU-bound threads share priority 20 and never yield. With
+ * timeslicing each must make progress while the other still runs: the
+ * first to finish has seen its sibling's counter move. Without it the
+ * first runs its 100ms to completion before the second starts.
+ */
+__USER_TEXT
+void test_sched_timeslice(void)
+{
+#ifdef CONFIG_SCHED_RR
+    L4_ThreadId_t self = L4_Myself();
+    L4_ThreadId_t tids[2];
+    L4_Word_t old_control;
+    int timeout, i;
+
+    TEST_RUN("sched_timeslice");
+
+    for (i = 0; i < 2; i++) {
+        rr_count[i] = 0;
+        rr_seen[i] = 0;
+        rr_done[i] = 0;
+        tids[i] = pager_create_thread();
+        if (tids[i].raw == 0) {
+            printf("Failed to create spinner %d\n", i);
+            TEST_FAIL("sched_timeslice");
+            return;
+        }
+    }
+
+    /* Stay above the spinners until both are started */
+    L4_Schedule(self, ~0UL, ~0UL, ~0UL, ~0UL, &old_control);
+    L4_Set_Priority(self, 18);
+
+    for (i = 0; i < 2; i++)
+        pager_start_thread(tids[i], rr_spinner_thread, (void *) i);
+
+    timeout = 50;
+    while (!(rr_done[0] && rr_done[1]) && timeout-- > 0)
+        L4_Sleep(L4_TimePeriod(10000));
+    L4_Set_Priority(self, old_control & 0xff);
+
+    printf("Timeslice: counts %lu/%lu, seen %lu/%lu\n",
+           (unsigned long) rr_count[0], (unsigned long) rr_count[1],
+           (unsigned long) rr_seen[0], (unsigned long) rr_seen[1]);
+
+    TEST_ASSERT("sched_timeslice",
+                rr_done[0] && rr_done[1] && rr_seen[0] && rr_seen[1]);
+#else
+    test_skip("sched_timeslice", "CONFIG_SCHED_RR not set");
+#endif
+}
+
+#if defined(CONFIG_SCHED_EDF) || defined(CONFIG_SCHED_BUDGET)
+__USER_TEXT
+static void sched_spin(uint32_t loops)
+{
+    for (volatile uint32_t i = 0; i < loops; i++)
+        ;
+}
+
+/* Busy-loop iterations per ms, measured over at least 10ms of wall
+ * clock so interrupt overhead is included.
+ */
+__USER_TEXT
+static uint32_t sched_spin_calibrate(void)
+{
+    L4_Clock_t start;
+    uint32_t loops, elapsed;
+
+    for (loops = 10000;; loops *= 2) {
+        start = L4_SystemClock();
+        sched_spin(loops);
+        elapsed = (uint32_t) (L4_SystemClock().raw - start.raw);
+        if (elapsed >= 10000)
+            break;
+    }
+
+    return (uint32_t) ((uint64_t) loops * 1000 / elapsed);
+}
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+/* EDF task set: C/T = 6/20, 9/30, 15/50 ms, 30% each (90% total). Not
+ * schedulable by any fixed-priority assignment under the RM bound (78%
+ * for three tasks); EDF meets every deadline up to 100%.
+ */
+#define SCHED_EDF_TASKS 3
+#define SCHED_EDF_HYPERPERIOD_US 300000
+
+struct edf_task {
+    uint32_t cost_ms;
+    uint32_t period_us;
+};
+
+__USER_DATA static const struct edf_task edf_tasks[SCHED_EDF_TASKS] = {
+    {6, 20000},
+    {9, 30000},
+    {15, 50000},
+};
+
+__USER_BSS static L4_ThreadId_t edf_tids[SCHED_EDF_TASKS];
+__USER_BSS static volatile uint32_t edf_loops_per_ms;
+__USER_BSS static volatile int edf_done[SCHED_EDF_TASKS];
+__USER_BSS static volatile int edf_misses[SCHED_EDF_TASKS];
+__USER_BSS static volatile int edf_jobs[SCHED_EDF_TASKS];
+
+/*
+ * EDF job loop: one job per release. A job that finishes after the next
+ * release has already been signalled overran its deadline; the pending
+ * release is consumed and the next job starts at once.
+ */
+__USER_TEXT
+static void *edf_task_thread(void *arg)
+{
+    int idx = (int) arg;
+    const struct edf_task *task = &edf_tasks[idx];
+    int jobs = SCHED_EDF_HYPERPERIOD_US / task->period_us;
+
+    L4_NotifyClear(L4_EDF_RELEASE_BIT);
+    if (L4_Set_Deadline(L4_Myself(), L4_TimePeriod(task->period_us)) ==
+        L4_SCHEDRESULT_ERROR) {
+        edf_misses[idx] = -1;
+        edf_done[idx] = 1;
+        return NULL;
+    }
+
+    for (int k = 0; k < jobs; k++) {
+        sched_spin(task->cost_ms * edf_loops_per_ms);
+        edf_jobs[idx]++;
+
+        if (L4_NotifyClear(L4_EDF_RELEASE_BIT) & L4_EDF_RELEASE_BIT)
+            edf_misses[idx]++;
+        else
+            L4_NotifyWait(L4_EDF_RELEASE_BIT);
+    }
+
+    edf_done[idx] = 1;
+    return NULL;
+}
+#endif
+
+/*
+ * Test: EDF Band at 90% Utilization
+ *
+ * Three periodic threads in the EDF band with implicit deadlines and a
+ * combined utilization of 90% run for one hyperperiod (300ms). Job cost
+ * is a busy loop calibrated against the system clock, so it includes
+ * interrupt overhead. No job may overrun its deadline.
+ */
+__USER_TEXT
+void test_sched_edf(void)
+{
+#ifdef CONFIG_SCHED_EDF
+    int timeout, misses, jobs, done;
+    int i;
+
+    TEST_RUN("sched_edf");
+
+    edf_loops_per_ms = sched_spin_calibrate();
+
+    for (i = 0; i < SCHED_EDF_TASKS; i++) {
+        edf_done[i] = 0;
+        edf_misses[i] = 0;
+        edf_jobs[i] = 0;
+        edf_tids[i] = pager_create_thread();
+        if (edf_tids[i].raw == 0) {
+            printf("Failed to create EDF thread %d\n", i);
+            TEST_FAIL("sched_edf");
+            return;
+        }
+    }
+
+    for (i = 0; i < SCHED_EDF_TASKS; i++)
+        pager_start_thread(edf_tids[i], edf_task_thread, (void *) i);
+
+    timeout = 100;
+    do {
+        L4_Sleep(L4_TimePeriod(10000));
+        done = 0;
+        for (i = 0; i < SCHED_EDF_TASKS; i++)
+            done += edf_done[i];
+    } while (done < SCHED_EDF_TASKS && --timeout > 0);
+
+    misses = 0;
+    jobs = 0;
+    for (i = 0; i < SCHED_EDF_TASKS; i++) {
+        misses += edf_misses[i];
+        jobs += edf_jobs[i];
+    }
+    printf("EDF: %d jobs, %d misses (%lu loops/ms)\n", jobs, misses,
+           (unsigned long) edf_loops_per_ms);
+
+    TEST_ASSERT("sched_edf", done == SCHED_EDF_TASKS && misses == 0);
+#else
+    test_skip("sched_edf", "CONFIG_SCHED_EDF not set");
+#endif
+}
+
+#ifdef CONFIG_SCHED_BUDGET
+#define SCHED_BUDGET_HOG_US 200000
+#define SCHED_BUDGET_WORK_MS 20
+
+__USER_BSS static volatile int budget_hog_done;
+
+/* Spins for 200ms of wall clock, whatever share of the CPU it gets */
+__USER_TEXT
+static void *budget_hog_thread(void *arg)
+{
+    L4_Clock_t start = L4_SystemClock();
+
+    while (L4_SystemClock().raw - start.raw < SCHED_BUDGET_HOG_US)
+        ;
+
+    budget_hog_done = 1;
+    return NULL;
+}
+#endif
+
+/*
+ * Test: CPU Budget Enforcement
+ *
+ * A CPU-bound thread above this one, limited to 2ms per 10ms, must not
+ * starve it: 20ms of work has to finish well before the hog's 200ms run
+ * is over. Without enforcement the hog holds the CPU for all of it.
+ */
+__USER_TEXT
+void test_sched_budget(void)
+{
+#ifdef CONFIG_SCHED_BUDGET
+    L4_ThreadId_t self = L4_Myself();
+    L4_ThreadId_t hog;
+    L4_Word_t old_control;
+    L4_Clock_t start;
+    uint32_t loops_per_ms, elapsed;
+    int hog_done, timeout;
+
+    TEST_RUN("sched_budget");
+
+    hog = pager_create_thread();
+    if (hog.raw == 0) {
+        printf("Failed to create hog thread\n");
+        TEST_FAIL("sched_budget");
+        return;
+    }
+
+    loops_per_ms = sched_spin_calibrate();
+    budget_hog_done = 0;
+
+    /* Low bits of the old control word are the current priority */
+    L4_Schedule(self, ~0UL, ~0UL, ~0UL, ~0UL, &old_control);
+    L4_Set_Priority(self, 20);
+    L4_Set_Priority(hog, 15);
+    if (L4_Set_Budget(hog, L4_TimePeriod(2000), L4_TimePeriod(10000)) ==
+        L4_SCHEDRESULT_ERROR) {
+        L4_Set_Priority(self, old_control & 0xff);
+        printf("Failed to set budget\n");
+        TEST_FAIL("sched_budget");
+        return;
+    }
+
+    start = L4_SystemClock();
+    pager_start_thread(hog, budget_hog_thread, NULL);
+    sched_spin(SCHED_BUDGET_WORK_MS * loops_per_ms);
+    elapsed = (uint32_t) (L4_SystemClock().raw - start.raw);
+    hog_done = budget_hog_done;
+
+    timeout = 50;
+    while (!budget_hog_done && timeout-- > 0)
+        L4_Sleep(L4_TimePeriod(10000));
+    L4_Set_Priority(self, old_control & 0xff);
+
+    printf("Budget: %dms of work took %lu us next to a 20%% hog\n",
+           SCHED_BUDGET_WORK_MS, (unsigned long) elapsed);
+
+    TEST_ASSERT("sched_budget",
+                !hog_done && elapsed < SCHED_BUDGET_HOG_US / 2);
+#else
+    test_skip("sched_budget", "CONFIG_SCHED_BUDGET not set");
+#endif
+}
+
+#ifdef CONFIG_SCHED_ADMISSION
+__USER_TEXT
+static void *admission_idle_thread(void *arg)
+{
+    return NULL;
+}
+#endif
+
+/*
+ * Test: Admission Control
+ *
+ * A at priority 10 takes 6ms per 10ms, B at 12 takes 5ms per 20ms; both
+ * meet their periods. Raising B above A would make A miss, and a budget
+ * of all B's period cannot fit next to A: both requests must fail and
+ * leave the set as it was.
+ */
+__USER_TEXT
+void test_sched_admission(void)
+{
+#ifdef CONFIG_SCHED_ADMISSION
+    L4_ThreadId_t a, b;
+    L4_Word_t old_control;
+    int ok = 1;
+
+    TEST_RUN("sched_admission");
+
+    a = pager_create_thread();
+    b = pager_create_thread();
+    if (a.raw == 0 || b.raw == 0) {
+        printf("Failed to create threads\n");
+        TEST_FAIL("sched_admission");
+        return;
+    }
+
+    L4_Set_Priority(a, 10);
+    L4_Set_Priority(b, 12);
+
+    if (L4_Set_Budget(a, L4_TimePeriod(6000), L4_TimePeriod(10000)) ==
+            L4_SCHEDRESULT_ERROR ||
+        L4_Set_Budget(b, L4_TimePeriod(5000), L4_TimePeriod(20000)) ==
+            L4_SCHEDRESULT_ERROR) {
+        printf("Schedulable set refused\n");
+        ok = 0;
+    }
+
+    if (L4_Set_Priority(b, 8) != L4_SCHEDRESULT_ERROR) {
+        printf("Priority raise admitted although A would miss\n");
+        ok = 0;
+    }
+
+    if (L4_Set_Budget(b, L4_TimePeriod(20000), L4_TimePeriod(20000)) !=
+        L4_SCHEDRESULT_ERROR) {
+        printf("Full budget admitted next to A\n");
+        ok = 0;
+    }
+
+    /* Low bits of the old control word are the current priority */
+    L4_Schedule(b, ~0UL, ~0UL, ~0UL, ~0UL, &old_control);
+    if ((old_control & 0xff) != 12) {
+        printf("Refused call changed priority to %lu\n",
+               (unsigned long) (old_control & 0xff));
+        ok = 0;
+    }
+
+    /* Exiting drops both from the set */
+    pager_start_thread(a, admission_idle_thread, NULL);
+    pager_start_thread(b, admission_idle_thread, NULL);
+
+    TEST_ASSERT("sched_admission", ok);
+#else
+    test_skip("sched_admission", "CONFIG_SCHED_ADMISSION not set");
+#endif
+}
+
+#ifdef CONFIG_SCHED_TT
+#define SCHED_TT_FRAMES 3
+#define SCHED_TT_OFFSET_US 40000
+#define SCHED_TT_LENGTH_US 20000
+/* Window edges fall on ktimer ticks, about 400us apart */
+#define SCHED_TT_TOLERANCE_US 1000
+/* A clock jump this large while spinning means the thread was parked */
+#define SCHED_TT_GAP_US 5000
+
+DECLARE_TT_WINDOW(sched_tt_test, SCHED_TT_OFFSET_US, SCHED_TT_LENGTH_US);
+
+__USER_BSS static volatile uint64_t tt_open_us[SCHED_TT_FRAMES];
+__USER_BSS static volatile uint32_t tt_run_us[SCHED_TT_FRAMES];
+__USER_BSS static volatile int tt_done;
+
+/* Spin through each window, stamping when it opened and how long the
+ * thread kept the CPU before it was parked again.
+ */
+__USER_TEXT
+static void *tt_window_thread(void *arg)
+{
+    L4_Clock_t start, last, now;
+
+    L4_NotifyClear(L4_TT_RELEASE_BIT);
+    if (L4_Set_Window(L4_Myself(), TT_WINDOW(sched_tt_test)) ==
+        L4_SCHEDRESULT_ERROR) {
+        tt_done = -1;
+        return NULL;
+    }
+
+    for (int i = 0; i < SCHED_TT_FRAMES; i++) {
+        L4_NotifyWait(L4_TT_RELEASE_BIT);
+        start = last = L4_SystemClock();
+        for (;;) {
+            now = L4_SystemClock();
+            if (now.raw - last.raw > SCHED_TT_GAP_US)
+                break;
+            last = now;
+        }
+        tt_open_us[i] = start.raw;
+        tt_run_us[i] = (uint32_t) (last.raw - start.raw);
+    }
+
+    /* Leave the window; 16 is the kernel's default priority */
+    L4_Set_Priority(L4_Myself(), 16);
+    tt_done = 1;
+    return NULL;
+}
+#endif
+
+/*
+ * Test: Time-Triggered Window Boundaries
+ *
+ * A CPU-bound thread bound to a 20ms window at 40ms into the major frame
+ * must run for the length of the window and no longer, and successive
+ * windows must open one major frame apart.
+ */
+__USER_TEXT
+void test_sched_time_triggered(void)
+{
+#ifdef CONFIG_SCHED_TT
+    L4_ThreadId_t tid;
+    int timeout, ok = 1;
+    uint32_t period;
+
+    TEST_RUN("sched_time_triggered");
+
+    tt_done = 0;
+    tid = pager_create_thread();
+    if (tid.raw == 0) {
+        printf("Failed to create window thread\n");
+        TEST_FAIL("sched_time_triggered");
+        return;
+    }
+    pager_start_thread(tid, tt_window_thread, NULL);
+
+    timeout = 100;
+    while (!tt_done && --timeout > 0)
+        L4_Sleep(L4_TimePeriod(10000));
+
+    if (tt_done != 1) {
+        printf("Window thread %s\n", tt_done ? "failed to bind" : "hung");
+        TEST_FAIL("sched_time_triggered");
+        return;
+    }
+
+    for (int i = 0; i < SCHED_TT_FRAMES; i++) {
+        period = i ? (uint32_t) (tt_open_us[i] - tt_open_us[i - 1])
+                   : CONFIG_SCHED_TT_MAJOR_FRAME;
+        printf("TT: window %d ran %lu us, %lu us after the last\n", i,
+               (unsigned long) tt_run_us[i], (unsigned long) period);
+
+        if (tt_run_us[i] + SCHED_TT_TOLERANCE_US < SCHED_TT_LENGTH_US ||
+            tt_run_us[i] > SCHED_TT_LENGTH_US + SCHED_TT_TOLERANCE_US ||
+            period + SCHED_TT_TOLERANCE_US < CONFIG_SCHED_TT_MAJOR_FRAME ||
+            period > CONFIG_SCHED_TT_MAJOR_FRAME + SCHED_TT_TOLERANCE_US)
+            ok = 0;
+    }
+
+    TEST_ASSERT("sched_time_triggered", ok);
+#else
+    test_skip("sched_time_triggered", "CONFIG_SCHED_TT not set");
+#endif
+}
+
+#ifdef CONFIG_SCHED_UPCALL
+#define SCHED_UPCALL_BIT 5
+#define SCHED_UPCALL_ROUNDS 3
+
+__USER_BSS static volatile int hs_runs;
+__USER_BSS static volatile int hs_spinning;
+__USER_BSS static volatile uint32_t hs_spins;
+__USER_BSS static volatile int hs_stop;
+
+/* Block SCHED_UPCALL_ROUNDS times, then stay runnable, yielding, until
+ * told to stop.
+ */
+__USER_TEXT
+static void *hs_band_thread(void *arg)
+{
+    for (int i = 0; i < SCHED_UPCALL_ROUNDS; i++) {
+        hs_runs++;
+        L4_Sleep(L4_TimePeriod(2000));
+    }
+
+    hs_spinning = 1;
+    while (!hs_stop) {
+        hs_spins++;
+        L4_Yield();
+    }
+    return NULL;
+}
+#endif
+
+/*
+ * Test: Scheduler Upcalls and ThreadSwitch
+ *
+ * The test thread acts as the user-level scheduler of a thread at its own
+ * level. Each time that thread blocks, the delegation's notification bit
+ * must be posted to the test thread; while it only yields, it must not.
+ * ThreadSwitch to it must let it run before the caller continues.
+ */
+__USER_TEXT
+void test_sched_upcall(void)
+{
+#ifdef CONFIG_SCHED_UPCALL
+    L4_Word_t bit = 1UL << SCHED_UPCALL_BIT;
+    L4_ThreadId_t tid;
+    int timeout, upcalls = 0, spurious = 0;
+    uint32_t spins;
+
+    TEST_RUN("sched_upcall");
+
+    hs_runs = hs_spinning = hs_stop = 0;
+    hs_spins = 0;
+    L4_NotifyClear(bit);
+
+    tid = pager_create_thread();
+    if (tid.raw == 0) {
+        printf("Failed to create band thread\n");
+        TEST_FAIL("sched_upcall");
+        return;
+    }
+
+    /* Delegate before the thread first runs */
+    if (L4_Set_Scheduler(tid, L4_Myself(), SCHED_UPCALL_BIT) ==
+        L4_SCHEDRESULT_ERROR) {
+        printf("Failed to delegate band thread\n");
+        TEST_FAIL("sched_upcall");
+        return;
+    }
+    pager_start_thread(tid, hs_band_thread, NULL);
+
+    /* Blocks close together may fold into one upcall */
+    timeout = 100;
+    while (!hs_spinning && --timeout > 0) {
+        L4_Sleep(L4_TimePeriod(1000));
+        if (L4_NotifyClear(bit))
+            upcalls++;
+    }
+    L4_NotifyClear(bit);
+
+    /* Yielding is not blocking */
+    for (int i = 0; i < 5; i++) {
+        L4_Sleep(L4_TimePeriod(1000));
+        if (L4_NotifyClear(bit))
+            spurious++;
+    }
+
+    spins = hs_spins;
+    L4_ThreadSwitch(tid);
+    printf("Upcalls: %d for %d blocks, %d while runnable, switch %s\n",
+           upcalls, hs_runs, spurious,
+           hs_spins != spins ? "ran it" : "did not run it");
+
+    L4_Set_Scheduler(tid, L4_nilthread, 0);
+    hs_stop = 1;
+
+    TEST_ASSERT("sched_upcall", hs_spinning && upcalls > 0 &&
+                                    upcalls <= SCHED_UPCALL_ROUNDS &&
+                                    !spurious && hs_spins != spins);
+#else
+    test_skip("sched_upcall", "CONFIG_SCHED_UPCALL not set");
+#endif
+}
+
+/*
+ * Test: Latency Histograms
+ *
+ * Three one-shot timer wakeups of this thread must each add a release
+ * sample, and the two waits that follow a wakeup a response sample.
+ */
+__USER_TEXT
+void test_sched_latency(void)
+{
+#ifdef CONFIG_LATENCY_HISTOGRAM
+    L4_Word16_t hist[LATHIST_KINDS][LATHIST_BUCKETS];
+    L4_Word_t bit = 1UL << 6;
+    uint32_t n[LATHIST_KINDS] = {0};
+
+    TEST_RUN("sched_latency");
+
+    for (int k = 0; k < LATHIST_KINDS; k++)
+        L4_LatencyStats(L4_nilthread, k | LATHIST_RESET, hist[k]);
+
+    L4_NotifyClear(bit);
+    for (int i = 0; i < 3; i++) {
+        if (!L4_TimerNotify(5, bit, 0)) {
+            printf("Failed to arm timer\n");
+            TEST_FAIL("sched_latency");
+            return;
+        }
+        L4_NotifyWait(bit);
+    }
+
+    for (int k = 0; k < LATHIST_KINDS; k++) {
+        if (L4_LatencyStats(L4_nilthread, k, hist[k]) != LATHIST_BUCKETS) {
+            printf("Failed to read histogram %d\n", k);
+            TEST_FAIL("sched_latency");
+            return;
+        }
+        printf("%s:", k == LATHIST_RELEASE ? "release" : "response");
+        for (int b = 0; b < LATHIST_BUCKETS; b++) {
+            printf(" %u", hist[k][b]);
+            n[k] += hist[k][b];
+        }
+        printf("\n");
+    }
+
+    TEST_ASSERT("sched_latency",
+                n[LATHIST_RELEASE] >= 3 && n[LATHIST_RESPONSE] >= 2);
+#else
+    test_skip("sched_latency", "CONFIG_LATENCY_HISTOGRAM not set");
+#endif
+}
+
 /*
  * Preemption-Threshold Scheduling (PTS) Tests
  *
@@ -5,6 +5,7 @@
 
 #include <l4/ipc.h>
 #include <l4/pager.h>
+#include <l4/schedule.h>
 #include <l4/thread.h>
 #include <l4/types.h>
 #include <l4io.h>
@@ -133,3 +134,143 @@ void test_thread_create(void)
         TEST_FAIL("thread_create");
     }
 }
+
+/* Thread lookup benchmark */
+#define THREAD_LOOKUP_ROUNDS 1000
+#define THREAD_CYCLE_ROUNDS 4
+
+/*
+ * Time THREAD_LOOKUP_ROUNDS scheduler queries on tid; each resolves tid
+ * through thread_by_globalid(). Returns elapsed microseconds and stores
+ * the last result in *res.
+ */
+__USER_TEXT
+static L4_Word_t thread_lookup_time(L4_ThreadId_t tid, L4_Word_t *res)
+{
+    L4_Clock_t start, end;
+    L4_Word_t dummy;
+    int i;
+
+    start = L4_SystemClock();
+    for (i = 0; i < THREAD_LOOKUP_ROUNDS; i++)
+        *res = L4_Schedule(tid, ~0UL, ~0UL, ~0UL, ~0UL, &dummy);
+    end = L4_SystemClock();
+
+    return (L4_Word_t) (end.raw - start.raw);
+}
+
+/*
+ * Test: Thread ID lookup cost and stale ID rejection.
+ *
+ * Resolves a live ID, an unused TID and a stale ID (live TID, another
+ * version) and reports the cost of each, plus a create/join cycle that
+ * inserts into and deletes from the thread map. Lookup is direct-indexed,
+ * so the numbers should not change with CONFIG_MAX_THREADS (compare builds
+ * at 32, 128 and 256).
+ */
+__USER_TEXT
+void test_thread_lookup(void)
+{
+    L4_ThreadId_t self, stale, unused, tid;
+    L4_Word_t hit_us, miss_us, stale_us, cycle_us;
+    L4_Word_t hit_res, miss_res, stale_res;
+    L4_Clock_t start, end;
+    int i;
+
+    TEST_RUN("thread_lookup");
+
+    self = L4_Myself();
+    stale.raw = (self.raw & ~0x3FFFUL) | ((self.raw & 0x3FFF) == 1 ? 2 : 1);
+    unused.raw = self.raw + (0x1000UL << 14);
+
+    hit_us = thread_lookup_time(self, &hit_res);
+    miss_us = thread_lookup_time(unused, &miss_res);
+    stale_us = thread_lookup_time(stale, &stale_res);
+
+    cycle_us = 0;
+    for (i = 0; i < THREAD_CYCLE_ROUNDS; i++) {
+        start = L4_SystemClock();
+        tid = pager_create_thread();
+        if (tid.raw == 0)
+            break;
+        pager_start_thread(tid, worker_thread, NULL);
+        pager_thread_join(tid, NULL);
+        end = L4_SystemClock();
+        cycle_us += (L4_Word_t) (end.raw - start.raw);
+    }
+
+    printf("Thread lookup: hit %lu cyc, miss %lu cyc, stale %lu cyc\n",
+           (unsigned long) (hit_us * TEST_CYCLES_PER_USEC /
+                            THREAD_LOOKUP_ROUNDS),
+           (unsigned long) (miss_us * TEST_CYCLES_PER_USEC /
+                            THREAD_LOOKUP_ROUNDS),
+           (unsigned long) (stale_us * TEST_CYCLES_PER_USEC /
+                            THREAD_LOOKUP_ROUNDS));
+    if (i)
+        printf("Thread create/join cycle: %lu us\n",
+               (unsigned long) (cycle_us / i));
+
+    TEST_ASSERT("thread_lookup", hit_res != L4_SCHEDRESULT_ERROR &&
+                                     miss_res == L4_SCHEDRESULT_ERROR &&
+                                     stale_res == L4_SCHEDRESULT_ERROR);
+}
+
+/* Stale-handle test: a notify timer armed by a thread that has exited */
+#define THREAD_STALE_BIT (1 << 7)
+#define THREAD_STALE_TICKS 10 /* ~4ms at the default heartbeat */
+
+__USER_BSS static volatile L4_Word_t stale_timer;
+__USER_BSS static volatile L4_Word_t stale_bits;
+
+__USER_TEXT
+static void *stale_arm_thread(void *arg)
+{
+    stale_timer = L4_TimerNotify(THREAD_STALE_TICKS, THREAD_STALE_BIT, 0);
+    return NULL;
+}
+
+__USER_TEXT
+static void *stale_probe_thread(void *arg)
+{
+    /* Outlive the first thread's timer, then look for its bit */
+    L4_Sleep(L4_TimePeriod(20000));
+    stale_bits = L4_NotifyClear(THREAD_STALE_BIT);
+    return NULL;
+}
+
+/*
+ * Test: Timer notifications do not outlive their thread.
+ *
+ * The first thread arms a one-shot notify timer and exits before it
+ * fires. A second thread, which normally reuses the freed TCB, must not
+ * receive the notification: the timer holds a generation-checked handle
+ * that stops resolving once its thread is destroyed.
+ */
+__USER_TEXT
+void test_thread_stale_handle(void)
+{
+    L4_ThreadId_t tid;
+
+    TEST_RUN("thread_stale_handle");
+
+    stale_timer = 0;
+    stale_bits = ~0UL;
+
+    tid = pager_create_thread();
+    if (tid.raw == 0) {
+        test_skip("thread_stale_handle", "no thread available");
+        return;
+    }
+    pager_start_thread(tid, stale_arm_thread, NULL);
+    pager_thread_join(tid, NULL);
+
+    tid = pager_create_thread();
+    if (tid.raw == 0) {
+        test_skip("thread_stale_handle", "no thread available");
+        return;
+    }
+    pager_start_thread(tid, stale_probe_thread, NULL);
+    pager_thread_join(tid, NULL);
+
+    TEST_ASSERT("thread_stale_handle", stale_timer != 0 && stale_bits == 0);
+}
@@ -4,7 +4,9 @@
  */
 
 #include <l4/ipc.h>
+#include <l4/thread.h>
 #include <l4io.h>
+#include <syscall.h>
 
 #include "tests.h"
 
@@ -45,3 +47,297 @@ void test_timer_sleep(void)
     /* If we get here, sleep works */
     TEST_PASS("timer_sleep");
 }
+
+/* Timer insertion stress: fill most of the ktimer event pool */
+#define TIMER_STRESS_BIT (1 << 8)
+#define TIMER_STRESS_BASE 200 /* First expiry, ticks (~80ms) */
+#define TIMER_STRESS_SPARE 16 /* Events left for other timers */
+#define TIMER_STRESS_MAX (CONFIG_MAX_KT_EVENTS - TIMER_STRESS_SPARE)
+
+/*
+ * Test: Cost of inserting timer events as the queue grows.
+ *
+ * Arms one-shot L4_TimerNotify events with increasing expiry, the worst
+ * case for a sorted list (every insert walks to the tail), and reports
+ * the average syscall cost over the first and last quarter of the run.
+ * With CONFIG_KTIMER_WHEEL the two should match; with the list the last
+ * quarter grows with the number of pending events. Build with
+ * CONFIG_MAX_KT_EVENTS=256 for a meaningful spread.
+ *
+ * All events must still fire: the thread then sees the notification bit.
+ */
+__USER_TEXT
+void test_timer_insert_stress(void)
+{
+    L4_Clock_t start, end;
+    L4_Word_t first_us = 0, last_us = 0, bits;
+    int n, quarter;
+
+    TEST_RUN("timer_insert_stress");
+
+    L4_NotifyClear(TIMER_STRESS_BIT);
+    quarter = TIMER_STRESS_MAX / 4;
+
+    for (n = 0; n < TIMER_STRESS_MAX; n++) {
+        L4_Word_t timer;
+
+        start = L4_SystemClock();
+        timer = L4_TimerNotify(TIMER_STRESS_BASE + n, TIMER_STRESS_BIT, 0);
+        end = L4_SystemClock();
+
+        /* Pool exhausted by events other tests left behind */
+        if (!timer)
+            break;
+
+        if (n < quarter)
+            first_us += (L4_Word_t) (end.raw - start.raw);
+        else if (n >= TIMER_STRESS_MAX - quarter)
+            last_us += (L4_Word_t) (end.raw - start.raw);
+    }
+
+    /* Wait out the last expiry (~0.4ms per tick) */
+    L4_Sleep(L4_TimePeriod((TIMER_STRESS_BASE + n) * 400 + 10000));
+    bits = L4_NotifyClear(TIMER_STRESS_BIT);
+
+    if (n >= TIMER_STRESS_MAX && quarter > 0)
+        printf("Timer insert (%d events): first %lu cyc, last %lu cyc\n", n,
+               (unsigned long) (first_us * TEST_CYCLES_PER_USEC / quarter),
+               (unsigned long) (last_us * TEST_CYCLES_PER_USEC / quarter));
+    else
+        printf("Timer insert: pool full after %d events\n", n);
+
+    TEST_ASSERT("timer_insert_stress", n > 0 && bits == TIMER_STRESS_BIT);
+}
+
+/* Clock reads per measurement; each run spans several ticks */
+#define TIMER_CLOCK_KIP_ROUNDS 100000
+#define TIMER_CLOCK_SVC_ROUNDS 4000
+
+__USER_TEXT
+static L4_Word_t timer_clock_measure(int svc, int rounds)
+{
+    L4_Clock_t start, end;
+
+    start = L4_SystemClock();
+    for (int n = 0; n < rounds; n++) {
+        if (svc)
+            L4_SystemClockSyscall();
+        else
+            L4_SystemClock();
+    }
+    end = L4_SystemClock();
+
+    return (L4_Word_t) (end.raw - start.raw);
+}
+
+/*
+ * Test: L4_SystemClock() from the KIP against SYS_SYSTEM_CLOCK.
+ *
+ * Alternating reads of the two must never go backwards, so the KIP
+ * clock neither lags nor leads the kernel's. Reports the average cost of
+ * a read either way; with precise timing the KIP read must be cheaper.
+ */
+__USER_TEXT
+void test_timer_kip_clock(void)
+{
+    L4_Clock_t kip, svc, prev;
+    L4_Word_t kip_us, svc_us;
+    int ok = 1;
+
+    TEST_RUN("timer_kip_clock");
+
+    prev = L4_SystemClock();
+    for (int n = 0; n < 1000; n++) {
+        kip = L4_SystemClock();
+        svc = L4_SystemClockSyscall();
+        if (kip.raw < prev.raw || svc.raw < kip.raw)
+            ok = 0;
+        prev = svc;
+    }
+
+    kip_us = timer_clock_measure(0, TIMER_CLOCK_KIP_ROUNDS);
+    svc_us = timer_clock_measure(1, TIMER_CLOCK_SVC_ROUNDS);
+
+    printf("Clock read: KIP %lu cyc, syscall %lu cyc\n",
+           (unsigned long) (kip_us * TEST_CYCLES_PER_USEC /
+                            TIMER_CLOCK_KIP_ROUNDS),
+           (unsigned long) (svc_us * TEST_CYCLES_PER_USEC /
+                            TIMER_CLOCK_SVC_ROUNDS));
+
+#ifdef CONFIG_HAS_PRECISE_TIMING
+    ok = ok && kip_us / (TIMER_CLOCK_KIP_ROUNDS / TIMER_CLOCK_SVC_ROUNDS) <
+                   svc_us;
+#endif
+    TEST_ASSERT("timer_kip_clock", ok);
+}
+
+/* High-resolution timers, with a tick timer as a guard against a lost
+ * compare interrupt
+ */
+#define TIMER_HIRES_BIT (1 << 9)
+#define TIMER_HIRES_GUARD_BIT (1 << 10)
+#define TIMER_HIRES_GUARD 100 /* Ticks (~40ms) */
+#define TIMER_HIRES_TICK_US 400
+
+/*
+ * Test: Microsecond one-shot timers.
+ *
+ * 100us lies within the next tick and fires from the TIM2 compare
+ * channel alone; 5ms first waits on SysTick. Each must arrive before the
+ * guard, and not earlier than its deadline by more than the one tick
+ * resolution of L4_SystemClock(). QEMU does not emulate TIM2 compare
+ * interrupts.
+ */
+__USER_TEXT
+void test_timer_hires(void)
+{
+#if defined(CONFIG_KTIMER_HIRES) && !defined(CONFIG_QEMU)
+    static const L4_Word_t usec[] = {100, 5000};
+    L4_Word_t mask = TIMER_HIRES_BIT | TIMER_HIRES_GUARD_BIT;
+
+    TEST_RUN("timer_hires");
+
+    for (int i = 0; i < 2; i++) {
+        L4_Clock_t start, end;
+        L4_Word_t bits, elapsed;
+
+        L4_NotifyClear(mask);
+        start = L4_SystemClock();
+        if (!L4_TimerNotify(usec[i], TIMER_HIRES_BIT, TIMER_NOTIFY_USEC) ||
+            !L4_TimerNotify(TIMER_HIRES_GUARD, TIMER_HIRES_GUARD_BIT, 0)) {
+            printf("Failed to arm timer\n");
+            TEST_FAIL("timer_hires");
+            return;
+        }
+        bits = L4_NotifyWait(mask);
+        end = L4_SystemClock();
+        elapsed = (L4_Word_t) (end.raw - start.raw);
+
+        printf("%luus timer fired after %luus\n", (unsigned long) usec[i],
+               (unsigned long) elapsed);
+
+        /* Let the guard expire so it cannot wake a later test */
+        if (!(bits & TIMER_HIRES_GUARD_BIT))
+            L4_NotifyWait(TIMER_HIRES_GUARD_BIT);
+
+        if (!(bits & TIMER_HIRES_BIT) ||
+            elapsed + TIMER_HIRES_TICK_US < usec[i]) {
+            TEST_FAIL("timer_hires");
+            return;
+        }
+    }
+
+    TEST_PASS("timer_hires");
+#else
+    test_skip("timer_hires", "CONFIG_KTIMER_HIRES not set or QEMU");
+#endif
+}
+
+/* Timer slack, with the timers further apart than CONFIG_KTIMER_MINTICKS
+ * so that they would not batch anyway
+ */
+#define TIMER_SLACK_ANCHOR_BIT (1 << 11)
+#define TIMER_SLACK_BIT (1 << 12)
+#define TIMER_SLACK_ANCHOR 400 /* Ticks (~160ms) */
+#define TIMER_SLACK_DUE 200
+
+/*
+ * Test: A timer with slack batches with a later one in its window.
+ *
+ * The slack timer is due 200 ticks before the anchor but may be 300
+ * late, so the kernel defers it onto the anchor's expiry and both
+ * notifications arrive in one batch.
+ */
+__USER_TEXT
+void test_timer_slack(void)
+{
+    L4_Word_t mask = TIMER_SLACK_ANCHOR_BIT | TIMER_SLACK_BIT;
+    L4_Word_t bits;
+
+    TEST_RUN("timer_slack");
+
+    L4_NotifyClear(mask);
+    if (!L4_TimerNotify(TIMER_SLACK_ANCHOR, TIMER_SLACK_ANCHOR_BIT, 0) ||
+        !L4_TimerNotify(TIMER_SLACK_DUE, TIMER_SLACK_BIT,
+                        TIMER_NOTIFY_SLACK(TIMER_SLACK_ANCHOR -
+                                           TIMER_SLACK_DUE + 100))) {
+        printf("Failed to arm timer\n");
+        TEST_FAIL("timer_slack");
+        return;
+    }
+
+    /* Batched, the other bit is already set once the wait returns */
+    bits = L4_NotifyWait(mask);
+    bits |= L4_NotifyClear(mask);
+    if (bits != mask)
+        L4_NotifyWait(mask & ~bits);
+
+    printf("First wakeup got bits 0x%lx\n", (unsigned long) bits);
+    TEST_ASSERT("timer_slack", bits == mask);
+}
+
+#define TIMER_RELEASE_PERIOD 5 /* Ticks (~2ms) */
+#define TIMER_RELEASE_JOBS 4
+
+/*
+ * Test: Absolute periodic releases.
+ *
+ * Releases that are waited for in time report no missed period, and
+ * follow the nominal schedule from the first release rather than the
+ * wakeups. A job that overruns by three periods finds the releases
+ * pending at its next wait, which returns at once with at least two
+ * missed. After
+ * RELEASE_STOP there is nothing left to wait for.
+ */
+__USER_TEXT
+void test_timer_periodic_release(void)
+{
+#ifdef CONFIG_PERIODIC_RELEASE
+    L4_Word64_t first, last;
+    L4_Word_t missed;
+
+    TEST_RUN("timer_periodic_release");
+
+    first = L4_SystemClockTicks() + TIMER_RELEASE_PERIOD;
+    if (L4_Release(RELEASE_SET, first, TIMER_RELEASE_PERIOD) != 0) {
+        printf("Failed to arm release\n");
+        TEST_FAIL("timer_periodic_release");
+        return;
+    }
+
+    for (int n = 0; n < TIMER_RELEASE_JOBS; n++) {
+        missed = L4_Release(RELEASE_WAIT, 0, 0);
+        if (missed != 0) {
+            printf("Job %d missed %lu periods\n", n, (unsigned long) missed);
+            L4_Release(RELEASE_STOP, 0, 0);
+            TEST_FAIL("timer_periodic_release");
+            return;
+        }
+    }
+
+    /* No drift: the last release comes no later than the nominal one.
+     * Chained with other events (CONFIG_KTIMER_MINTICKS) it may be early.
+     */
+    last = first + (TIMER_RELEASE_JOBS - 1) * TIMER_RELEASE_PERIOD;
+    if (L4_SystemClockTicks() > last + TIMER_RELEASE_PERIOD) {
+        printf("Released at %lu, nominal %lu\n",
+               (unsigned long) L4_SystemClockTicks(), (unsigned long) last);
+        L4_Release(RELEASE_STOP, 0, 0);
+        TEST_FAIL("timer_periodic_release");
+        return;
+    }
+
+    /* Overrun three periods */
+    while (L4_SystemClockTicks() < last + 3 * TIMER_RELEASE_PERIOD + 1)
+        ;
+    missed = L4_Release(RELEASE_WAIT, 0, 0);
+    printf("Overrun of 3 periods reported %lu missed\n",
+           (unsigned long) missed);
+
+    L4_Release(RELEASE_STOP, 0, 0);
+    TEST_ASSERT("timer_periodic_release",
+                missed >= 2 && L4_Release(RELEASE_WAIT, 0, 0) == ~0UL);
+#else
+    test_skip("timer_periodic_release", "CONFIG_PERIODIC_RELEASE not set");
+#endif
+}
@@ -7,6 +7,7 @@
 #define TESTS_H
 
 #include <test_framework.h>
+#include INC_PLAT(systick.h)
 
 /**
  * Kernel Test Suite
@@ -37,21 +38,37 @@ extern test_context_t test_ctx;
         }                            \
     } while (0)
 
+/* Core cycles per microsecond, to report microsecond timings as cycles.
+ * Only nominal without CONFIG_HAS_PRECISE_TIMING (e.g. under QEMU).
+ */
+#define TEST_CYCLES_PER_USEC (CORE_CLOCK / 1000000)
+
 /* Test function declarations */
 
 /* IPC tests (test-ipc.c) */
 void test_ipc_basic(void);
 void test_ipc_multiword(void);
+void test_ipc_sender_order(void);
+void test_ipc_call(void);
+void test_ipc_switch_cycles(void);
+void test_ipc_string(void);
 
 /* Thread tests (test-thread.c) */
 void test_thread_self(void);
 void test_thread_global_id(void);
 void test_thread_pager(void);
 void test_thread_create(void);
+void test_thread_lookup(void);
+void test_thread_stale_handle(void);
 
 /* Timer tests (test-timer.c) */
 void test_timer_period(void);
 void test_timer_sleep(void);
+void test_timer_insert_stress(void);
+void test_timer_kip_clock(void);
+void test_timer_hires(void);
+void test_timer_slack(void);
+void test_timer_periodic_release(void);
 
 /* KIP tests (test-kip.c) */
 void test_kip_access(void);
@@ -65,6 +82,7 @@ void test_irq_exti(void);
 /* Functional safety tests (test-safety.c) */
 void test_ipc_timeout_send(void);
 void test_ipc_timeout_receive(void);
+void test_ipc_timeout_reuse(void);
 void test_timer_zero_sleep(void);
 void test_timer_monotonicity(void);
 void test_thread_priority(void);
@@ -76,8 +94,18 @@ void test_sched_round_robin(void);
 void test_sched_no_starvation(void);
 void test_sched_yield_returns(void);
 void test_sched_idle_fallback(void);
-void test_sched_ipc_priority_boost(void);
+void test_sched_ipc_donation(void);
 void test_sched_syscall(void);
+void test_sched_lazy_ipc(void);
+void test_sched_cpu_time(void);
+void test_sched_priority_range(void);
+void test_sched_timeslice(void);
+void test_sched_edf(void);
+void test_sched_budget(void);
+void test_sched_admission(void);
+void test_sched_time_triggered(void);
+void test_sched_upcall(void);
+void test_sched_latency(void);
 
 /* PTS (Preemption-Threshold Scheduling) tests */
 void test_pts_threshold_set(void);
@@ -39,6 +39,14 @@ L4_Word_t L4_ThreadControl(L4_ThreadId_t dest,
 __USER_TEXT
 L4_Clock_t L4_SystemClock(void);
 
+/* Same clock through SYS_SYSTEM_CLOCK */
+__USER_TEXT
+L4_Clock_t L4_SystemClockSyscall(void);
+
+/* Raw ktimer ticks since boot from the KIP, the unit of L4_Release */
+__USER_TEXT
+L4_Word64_t L4_SystemClockTicks(void);
+
 __USER_TEXT
 void L4_ThreadSwitch(L4_ThreadId_t dest);
 
@@ -49,10 +57,23 @@ L4_Word_t L4_Schedule(L4_ThreadId_t dest,
                       L4_Word_t PrioControl,
                       L4_Word_t PreemptionControl,
                       L4_Word_t *old_TimeControl);
+
+/* Post notify_bits to the caller in ticks. flags are TIMER_NOTIFY_*
+ * (syscall.h); TIMER_NOTIFY_SLACK(n) lets the timer fire up to n ticks
+ * late to batch with other timers. Returns a timer handle, 0 on failure.
+ */
 __USER_TEXT
 L4_Word_t L4_TimerNotify(L4_Word_t ticks,
                          L4_Word_t notify_bits,
-                         L4_Word_t periodic);
+                         L4_Word_t flags);
+
+/* Cancel or query a timer handle from L4_TimerNotify(). op is a TIMER_*
+ * operation (syscall.h); TIMER_OVERRUN returns and resets the expiries
+ * that found the timer's bits still pending. ~0 on error.
+ */
+__USER_TEXT
+L4_Word_t L4_TimerControl(L4_Word_t op, L4_Word_t handle);
+
 __USER_TEXT
 L4_MsgTag_t L4_Ipc(L4_ThreadId_t to,
                    L4_ThreadId_t FromSpecifier,
@@ -91,4 +112,44 @@ L4_Word_t L4_NotifyPost(L4_ThreadId_t target, L4_Word_t bits);
 __USER_TEXT
 L4_Word_t L4_NotifyClear(L4_Word_t bits);
 
+/* CPU time in core cycles. which is a CPUTIME_* selector (syscall.h);
+ * tid selects the thread for CPUTIME_THREAD, L4_nilthread for the caller.
+ * Returns 0 when accounting is not configured.
+ */
+__USER_TEXT
+L4_Word64_t L4_CpuTime(L4_Word_t which, L4_ThreadId_t tid);
+
+/* Priority-ceiling mutex object. op is a KMUTEX_* operation (syscall.h);
+ * handle and arg as described there. Without CONFIG_KMUTEX, KMUTEX_CREATE
+ * returns 0.
+ */
+__USER_TEXT
+L4_Word_t L4_KMutex(L4_Word_t op, L4_Word_t handle, L4_Word_t arg);
+
+/* Latency histogram of tid (L4_nilthread for the caller) into buf, which
+ * holds LATHIST_BUCKETS counts. kind is a LATHIST_* selector, optionally
+ * with LATHIST_RESET (syscall.h) if tid shares the caller's address space.
+ * Returns the number of buckets written, 0 on error or without
+ * CONFIG_LATENCY_HISTOGRAM.
+ */
+__USER_TEXT
+L4_Word_t L4_LatencyStats(L4_ThreadId_t tid, L4_Word_t kind, L4_Word16_t *buf);
+
+/* Absolute periodic releases of the caller. op is a RELEASE_* operation
+ * (syscall.h). For RELEASE_SET, first is the first release on the
+ * L4_SystemClockTicks() clock (0 for one period from now) and period the
+ * release period in ticks (0 for a single release). RELEASE_WAIT returns
+ * the periods missed since the last wait. ~0 on error, including
+ * RELEASE_SET by an EDF or time-triggered thread or while periodic
+ * releases are armed. Only with CONFIG_PERIODIC_RELEASE.
+ */
+__USER_TEXT
+L4_Word_t L4_Release(L4_Word_t op, L4_Word64_t first, L4_Word_t period);
+
+/* Scheduler queue statistic; which is a SCHEDSTAT_* selector (syscall.h).
+ * Only with CONFIG_KDB.
+ */
+__USER_TEXT
+L4_Word_t L4_SchedStat(L4_Word_t which);
+
 #endif /* !__L4_PLATFORM_SYSCALLS_H__ */
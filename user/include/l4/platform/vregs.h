@@ -66,6 +66,34 @@ L4_INLINE void __L4_TCR_Set_ExceptionHandler(L4_Word_t w)
     __L4_Utcb()->exception_handler = w;
 }
 
+/* Priority-ceiling mutex held (kmutex handle, 0 = none) with its ceiling,
+ * and the kernel's note that it raised the owner to the ceiling.
+ */
+L4_INLINE L4_Word_t __L4_TCR_CeilingMutex(void)
+{
+    return __L4_Utcb()->ceiling_mutex;
+}
+
+L4_INLINE void __L4_TCR_Set_CeilingMutex(L4_Word_t w)
+{
+    __L4_Utcb()->ceiling_mutex = w;
+}
+
+L4_INLINE L4_Word_t __L4_TCR_CeilingPrio(void)
+{
+    return __L4_Utcb()->ceiling_prio;
+}
+
+L4_INLINE void __L4_TCR_Set_CeilingPrio(L4_Word_t w)
+{
+    __L4_Utcb()->ceiling_prio = w;
+}
+
+L4_INLINE L4_Word_t __L4_TCR_CeilingRaised(void)
+{
+    return *(volatile uint8_t *) &__L4_Utcb()->ceiling_raised;
+}
+
 L4_INLINE L4_Word_t __L4_TCR_ErrorCode(void)
 {
     return __L4_Utcb()->error_code;
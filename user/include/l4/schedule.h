@@ -37,6 +37,14 @@ L4_INLINE L4_Word_t L4_Set_ProcessorNo(L4_ThreadId_t tid, L4_Word_t cpu_no)
     return L4_Schedule(tid, ~0UL, cpu_no, ~0UL, ~0UL, &dummy);
 }
 
+/*
+ * Round-robin timeslice (CONFIG_SCHED_RR)
+ *
+ * With totalquantum L4_Never, sets tid's timeslice: after running that long
+ * while another thread is ready at its priority, tid moves to the back of
+ * the level. L4_Never as timeslice disables timeslicing for tid. A finite
+ * totalquantum sets a CPU budget instead (see L4_Set_Budget()).
+ */
 L4_INLINE L4_Word_t L4_Set_Timeslice(L4_ThreadId_t tid,
                                      L4_Time_t timeslice,
                                      L4_Time_t totalquantum)
@@ -56,6 +64,28 @@ L4_INLINE L4_Word_t L4_Timeslice(L4_ThreadId_t tid,
     return res;
 }
 
+/*
+ * CPU budget (sporadic server)
+ *
+ * Lets tid run at its priority for at most 'budget' in any window of
+ * 'period'; each slice it runs is returned one period after it started.
+ * Once exhausted it drops to CONFIG_SCHED_BUDGET_LOW_PRIO until budget is
+ * returned. A budget of L4_Never removes the limit. Fails if budget
+ * exceeds period, or if the kernel lacks CONFIG_SCHED_BUDGET.
+ *
+ * Shares time_control with L4_Set_Timeslice(): the total quantum is the
+ * budget, and while it is finite the timeslice field is the period.
+ */
+L4_INLINE L4_Word_t L4_Set_Budget(L4_ThreadId_t tid,
+                                  L4_Time_t budget,
+                                  L4_Time_t period)
+{
+    L4_Word_t dummy;
+    L4_Word_t timectrl = ((L4_Word_t) period.raw << 16) | budget.raw;
+
+    return L4_Schedule(tid, timectrl, ~0UL, ~0UL, ~0UL, &dummy);
+}
+
 /*
  * Set preemption threshold for Preemption-Threshold Scheduling (PTS)
  *
@@ -84,6 +114,77 @@ L4_INLINE L4_Word_t L4_Set_PreemptionDelay(L4_ThreadId_t tid,
     return L4_Schedule(tid, ~0UL, ~0UL, ~0UL, pctrl, old_threshold);
 }
 
+#ifdef CONFIG_IPC_DIRECT_SWITCH
+/*
+ * Turn the IPC direct process switch off (on = 0) or back on for IPC that
+ * tid sends. Fastpath IPC then switches through PendSV like the slowpath;
+ * the scheduling decision is the same. Meant for measuring the switch.
+ */
+L4_INLINE L4_Word_t L4_Set_DirectSwitch(L4_ThreadId_t tid, int on)
+{
+    L4_Word_t dummy;
+    L4_Word_t pctrl = (0xff << 16) | (1 << 24) | (on ? 0 : 1);
+
+    return L4_Schedule(tid, ~0UL, ~0UL, ~0UL, pctrl, &dummy);
+}
+#endif
+
+#ifdef CONFIG_SCHED_EDF
+/*
+ * Earliest-deadline-first band
+ *
+ * Moves tid to priority CONFIG_SCHED_EDF_PRIO with a periodic release every
+ * 'deadline' (implicit deadline: relative deadline == period). Threads in
+ * the band run in order of absolute deadline; the first job is released
+ * at the call. Each later release sets L4_EDF_RELEASE_BIT, so a job loop
+ * ends with L4_NotifyWait(L4_EDF_RELEASE_BIT). A release that finds the
+ * thread still runnable counts as a deadline miss (see KDB 'Q').
+ *
+ * Setting any other priority with L4_Set_Priority() leaves the band.
+ */
+#define L4_EDF_RELEASE_BIT (1UL << 31)
+
+L4_INLINE L4_Word_t L4_Set_Deadline(L4_ThreadId_t tid, L4_Time_t deadline)
+{
+    L4_Word_t dummy;
+    L4_Word_t prio_control =
+        ((L4_Word_t) deadline.raw << 16) | CONFIG_SCHED_EDF_PRIO;
+
+    return L4_Schedule(tid, ~0UL, ~0UL, prio_control, ~0UL, &dummy);
+}
+#endif
+
+#ifdef CONFIG_SCHED_TT
+/*
+ * Time-triggered windows
+ *
+ * Adds window TT_WINDOW(name) (see DECLARE_TT_WINDOW in user_runtime.h) to
+ * tid's windows; the first binding starts the major frame. tid then runs
+ * at priority L4_TT_PRIO only while one of its windows is open, and each
+ * opening sets L4_TT_RELEASE_BIT. A window has a single owner.
+ *
+ * Setting any other priority with L4_Set_Priority() releases the windows.
+ */
+#define L4_TT_PRIO 3
+#define L4_TT_RELEASE_BIT (1UL << 31)
+
+L4_INLINE L4_Word_t L4_Set_Window(L4_ThreadId_t tid, L4_Word_t window)
+{
+    L4_Word_t dummy;
+    L4_Word_t prio_control = (window << 16) | L4_TT_PRIO;
+
+    return L4_Schedule(tid, ~0UL, ~0UL, prio_control, ~0UL, &dummy);
+}
+#endif
+
+/*
+ * Hierarchical scheduling
+ *
+ * Delegates tid to the user-level scheduler domain, nilthread for none.
+ * control is the notification bit (0-31) the kernel posts to domain when
+ * tid blocks or runs out of CPU budget. The preemption threshold is left
+ * unchanged.
+ */
 L4_INLINE L4_Word_t L4_HS_Schedule(L4_ThreadId_t tid,
                                    L4_Word_t control,
                                    L4_ThreadId_t domain,
@@ -91,7 +192,8 @@ L4_INLINE L4_Word_t L4_HS_Schedule(L4_ThreadId_t tid,
                                    L4_Word_t stride,
                                    L4_Word_t *old_control)
 {
-    L4_Word_t preemption_control = ((control & 0x3f) << 26) | (1 << 25);
+    L4_Word_t preemption_control =
+        ((control & 0x3f) << 26) | (1 << 25) | (0xff << 16);
     L4_Word_t time_control = domain.raw;
     L4_Word_t prio_control = (stride << 16) | (prio & 0x1ff);
 
@@ -99,6 +201,22 @@ L4_INLINE L4_Word_t L4_HS_Schedule(L4_ThreadId_t tid,
                        preemption_control, old_control);
 }
 
+#ifdef CONFIG_SCHED_UPCALL
+/*
+ * Name sched as tid's scheduler, to be posted notification bit 'bit'.
+ * The scheduler waits for the bits of its threads with L4_NotifyWait()
+ * and hands the CPU on with L4_ThreadSwitch().
+ */
+L4_INLINE L4_Word_t L4_Set_Scheduler(L4_ThreadId_t tid,
+                                     L4_ThreadId_t sched,
+                                     L4_Word_t bit)
+{
+    L4_Word_t dummy;
+
+    return L4_HS_Schedule(tid, bit, sched, 0xff, 0, &dummy);
+}
+#endif
+
 /*
  * Result values from schedule system call
  */
@@ -14,9 +14,20 @@
 #define SCHED_FIFO 1  /* First-in-first-out scheduling */
 #define SCHED_RR 2    /* Round-robin scheduling */
 
-/* Priority range for SCHED_FIFO and SCHED_RR */
+/* Priority range for SCHED_FIFO and SCHED_RR: one value per kernel level
+ * open to user threads, higher is more urgent. POSIX priority p is L4
+ * priority SCHED_PRIORITY_MAX + 4 - p, so 1 is the lowest user level and
+ * SCHED_PRIORITY_MAX is L4 priority 4.
+ */
 #define SCHED_PRIORITY_MIN 1
-#define SCHED_PRIORITY_MAX 255
+#ifdef CONFIG_SCHED_PRIO_256
+#define SCHED_PRIORITY_MAX 251
+#else
+#define SCHED_PRIORITY_MAX 27
+#endif
+
+/* L4 priority 16, the kernel's default for new threads */
+#define SCHED_PRIORITY_DEFAULT (SCHED_PRIORITY_MAX + 4 - 16)
 
 /* Scheduling parameter structure - defined in sys/types.h */
 
@@ -31,7 +31,7 @@ typedef struct {
 } pthread_t;
 
 typedef struct {
-    uint32_t priority;    /* Thread priority (1-255) */
+    uint32_t priority;    /* Thread priority (SCHED_PRIORITY_MIN-MAX) */
     uint32_t stack_size;  /* Stack size (default: 512 bytes) */
     uint32_t detachstate; /* PTHREAD_CREATE_DETACHED/JOINABLE */
 } pthread_attr_t;
@@ -53,12 +53,20 @@ typedef struct {
     uint32_t waiters_lock; /* Spinlock for waiter list serialization */
     uint32_t num_waiters;  /* Number of threads in wait list */
     L4_ThreadId_t waiters[MUTEX_MAX_WAITERS]; /* Waiting thread IDs */
+    uint8_t protocol;      /* PTHREAD_PRIO_NONE/PROTECT */
+    uint8_t prioceiling;   /* Ceiling (POSIX priority) for PRIO_PROTECT */
+    uint16_t kmutex;       /* Kernel ceiling mutex handle for PRIO_PROTECT */
+    uint16_t ceiling_prev; /* Owner's UTCB ceiling mutex before locking */
+    uint8_t ceiling;       /* L4 priority of the kernel mutex's ceiling */
+    uint8_t ceiling_prev_prio; /* L4 ceiling of ceiling_prev */
 } pthread_mutex_t;
 
 typedef struct {
     uint8_t type : 2;        /* PTHREAD_MUTEX_NORMAL/RECURSIVE (0-3) */
     uint8_t initialized : 1; /* Validation flag */
-    uint8_t _reserved : 5;
+    uint8_t protocol : 2;    /* PTHREAD_PRIO_NONE/INHERIT/PROTECT */
+    uint8_t _reserved : 3;
+    uint8_t prioceiling; /* Ceiling (POSIX priority) for PRIO_PROTECT */
 } pthread_mutexattr_t;
 
 /* Static initializer sentinel - enables lazy initialization
@@ -83,6 +91,7 @@ typedef struct {
 #define SEM_NOTIFY_BIT (1U << 0)         /* Semaphore wakeup */
 #define POSIX_NOTIFY_MUTEX_BIT (1U << 1) /* Mutex wakeup */
 #define POSIX_NOTIFY_COND_BIT (1U << 2)  /* Condition variable wakeup */
+#define POSIX_NOTIFY_TIMER_BIT (1U << 3) /* SIGEV_THREAD timer queued */
 #define POSIX_NOTIFY_TIMEOUT_BIT \
     (1U << 30) /* Timed wait timeout (high bit avoids IRQ collision) */
 
@@ -218,6 +227,14 @@ typedef struct {
 #define PTHREAD_MUTEX_NORMAL 0
 #define PTHREAD_MUTEX_RECURSIVE 1
 
+/* Mutex protocols. PTHREAD_PRIO_PROTECT maps onto a kernel
+ * priority-ceiling mutex (CONFIG_KMUTEX); PTHREAD_PRIO_INHERIT is not
+ * supported.
+ */
+#define PTHREAD_PRIO_NONE 0
+#define PTHREAD_PRIO_INHERIT 1
+#define PTHREAD_PRIO_PROTECT 2
+
 /* Thread cancellation constants (PSE51 POSIX_THREADS_BASE) */
 #define PTHREAD_CANCEL_ENABLE 0
 #define PTHREAD_CANCEL_DISABLE 1
@@ -55,9 +55,20 @@ int timer_settime(timer_t timerid,
 int timer_gettime(timer_t timerid, struct itimerspec *value);
 int timer_getoverrun(timer_t timerid);
 
+/* Timer slack (non-portable): expiries may come up to slack late */
+int timer_setslack_np(timer_t timerid, const struct timespec *slack);
+
 /* Nanosleep (1003.1b-93) */
 int nanosleep(const struct timespec *rqtp, struct timespec *rmtp);
 
+/* clock_nanosleep flags */
+#define TIMER_ABSTIME 1
+
+int clock_nanosleep(clockid_t clock_id,
+                    int flags,
+                    const struct timespec *rqtp,
+                    struct timespec *rmtp);
+
 /* Notification types */
 #define SIGEV_NONE 0
 #define SIGEV_SIGNAL 1
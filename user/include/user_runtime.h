@@ -45,6 +45,29 @@ struct user_struct {
             L4_Sleep(L4_Never);                                            \
     }
 
+/* Time-triggered window (CONFIG_SCHED_TT), offsets in microseconds from
+ * the start of the major frame. The kernel reads the table the linker
+ * builds from these; threads bind to a window with L4_Set_Window().
+ */
+typedef struct {
+    L4_Word_t offset;
+    L4_Word_t length;
+    const char *name;
+} user_tt_window;
+
+extern user_tt_window tt_table_start[];
+
+#define DECLARE_TT_WINDOW(_name, _offset, _length) \
+    user_tt_window _tt_window_##_name              \
+        __attribute__((section(".tt_table"))) = {  \
+            .offset = _offset,                     \
+            .length = _length,                     \
+            .name = #_name,                        \
+    };
+
+/* Window number of a DECLARE_TT_WINDOW entry, for L4_Set_Window() */
+#define TT_WINDOW(_name) (&_tt_window_##_name - tt_table_start + 1)
+
 #include <l4/pager.h>
 
 #endif /* USER_RUNTIME_H */
@@ -5,6 +5,7 @@
 
 /* ARM Cortex-M syscall implementations */
 
+#include <l4/kip_types.h>
 #include <l4/types.h>
 #include <l4/utcb.h>
 #include <platform/link.h>
@@ -60,8 +61,39 @@ L4_Word_t L4_ThreadControl(L4_ThreadId_t dest,
     return r0;
 }
 
+/* Read the clock the kernel publishes in the KIP, without a syscall. The
+ * SysTick current value sits in the private peripheral bus, which
+ * unprivileged code cannot read, so the result keeps tick resolution
+ * like SYS_SYSTEM_CLOCK.
+ */
+__USER_TEXT
+L4_Word64_t L4_SystemClockTicks(void)
+{
+    const volatile kip_clock_t *clk = &((kip_t *) &kip_start)->clock;
+    uint32_t seq, lo, hi;
+
+    do {
+        seq = clk->seq;
+        lo = clk->ticks_lo;
+        hi = clk->ticks_hi;
+    } while ((seq & 1) || clk->seq != seq);
+
+    return ((uint64_t) hi << 32) | lo;
+}
+
 __USER_TEXT
 L4_Clock_t L4_SystemClock(void)
+{
+    const kip_clock_t *clk = &((kip_t *) &kip_start)->clock;
+    L4_Clock_t result;
+
+    result.raw = (L4_SystemClockTicks() * clk->usec_per_tick) >>
+                 KIP_CLOCK_SHIFT;
+    return result;
+}
+
+__USER_TEXT
+L4_Clock_t L4_SystemClockSyscall(void)
 {
     register L4_Word_t r0 __asm__("r0");
     register L4_Word_t r1 __asm__("r1");
@@ -77,7 +109,15 @@ L4_Clock_t L4_SystemClock(void)
 }
 
 __USER_TEXT
-void L4_ThreadSwitch(L4_ThreadId_t dest) {}
+void L4_ThreadSwitch(L4_ThreadId_t dest)
+{
+    register L4_Word_t r0 __asm__("r0") = dest.raw;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0)
+                         : [syscall_num] "i"(SYS_THREAD_SWITCH)
+                         : "memory", "r1", "r2", "r3", "r12");
+}
 
 __USER_TEXT
 L4_Word_t L4_Schedule(L4_ThreadId_t dest,
@@ -110,11 +150,11 @@ L4_Word_t L4_Schedule(L4_ThreadId_t dest,
 __USER_TEXT
 L4_Word_t L4_TimerNotify(L4_Word_t ticks,
                          L4_Word_t notify_bits,
-                         L4_Word_t periodic)
+                         L4_Word_t flags)
 {
     register L4_Word_t r0 __asm__("r0") = ticks;
     register L4_Word_t r1 __asm__("r1") = notify_bits;
-    register L4_Word_t r2 __asm__("r2") = periodic;
+    register L4_Word_t r2 __asm__("r2") = flags;
 
     __asm__ __volatile__("svc %[syscall_num]\n"
                          : "+r"(r0), "+r"(r1), "+r"(r2)
@@ -124,6 +164,20 @@ L4_Word_t L4_TimerNotify(L4_Word_t ticks,
     return r0;
 }
 
+__USER_TEXT
+L4_Word_t L4_TimerControl(L4_Word_t op, L4_Word_t handle)
+{
+    register L4_Word_t r0 __asm__("r0") = op;
+    register L4_Word_t r1 __asm__("r1") = handle;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0), "+r"(r1)
+                         : [syscall_num] "i"(SYS_TIMER_CONTROL)
+                         : "memory", "r2", "r3", "r12");
+
+    return r0;
+}
+
 __USER_TEXT
 L4_MsgTag_t L4_Ipc(L4_ThreadId_t to,
                    L4_ThreadId_t FromSpecifier,
@@ -269,3 +323,76 @@ L4_Word_t L4_NotifyClear(L4_Word_t bits)
 
     return r0;
 }
+
+__USER_TEXT
+L4_Word64_t L4_CpuTime(L4_Word_t which, L4_ThreadId_t tid)
+{
+    register L4_Word_t r0 __asm__("r0") = which;
+    register L4_Word_t r1 __asm__("r1") = tid.raw;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0), "+r"(r1)
+                         : [syscall_num] "i"(SYS_CPU_TIME)
+                         : "memory", "r2", "r3", "r12");
+
+    return ((L4_Word64_t) r1 << 32) | r0;
+}
+
+__USER_TEXT
+L4_Word_t L4_KMutex(L4_Word_t op, L4_Word_t handle, L4_Word_t arg)
+{
+    register L4_Word_t r0 __asm__("r0") = op;
+    register L4_Word_t r1 __asm__("r1") = handle;
+    register L4_Word_t r2 __asm__("r2") = arg;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0), "+r"(r1), "+r"(r2)
+                         : [syscall_num] "i"(SYS_KMUTEX)
+                         : "memory", "r3", "r12");
+
+    return r0;
+}
+
+__USER_TEXT
+L4_Word_t L4_LatencyStats(L4_ThreadId_t tid, L4_Word_t kind, L4_Word16_t *buf)
+{
+    register L4_Word_t r0 __asm__("r0") = tid.raw;
+    register L4_Word_t r1 __asm__("r1") = kind;
+    register L4_Word_t r2 __asm__("r2") = (L4_Word_t) buf;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0), "+r"(r1), "+r"(r2)
+                         : [syscall_num] "i"(SYS_LATENCY)
+                         : "memory", "r3", "r12");
+
+    return r0;
+}
+
+__USER_TEXT
+L4_Word_t L4_Release(L4_Word_t op, L4_Word64_t first, L4_Word_t period)
+{
+    register L4_Word_t r0 __asm__("r0") = op;
+    register L4_Word_t r1 __asm__("r1") = (L4_Word_t) first;
+    register L4_Word_t r2 __asm__("r2") = (L4_Word_t) (first >> 32);
+    register L4_Word_t r3 __asm__("r3") = period;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0), "+r"(r1), "+r"(r2), "+r"(r3)
+                         : [syscall_num] "i"(SYS_RELEASE)
+                         : "memory", "r12");
+
+    return r0;
+}
+
+__USER_TEXT
+L4_Word_t L4_SchedStat(L4_Word_t which)
+{
+    register L4_Word_t r0 __asm__("r0") = which;
+
+    __asm__ __volatile__("svc %[syscall_num]\n"
+                         : "+r"(r0)
+                         : [syscall_num] "i"(SYS_SCHED_STATS)
+                         : "memory", "r1", "r2", "r3", "r12");
+
+    return r0;
+}
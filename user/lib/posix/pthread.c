@@ -12,6 +12,7 @@
 #include <platform/link.h>
 #include <posix/pthread.h>
 #include <posix/sched.h>
+#include <syscall.h>
 #include __L4_INC_ARCH(syscalls.h)
 
 /* Signal cleanup function - defined in signal.c */
@@ -84,7 +85,7 @@ int pthread_attr_init(pthread_attr_t *attr)
     if (!attr)
         return EINVAL;
 
-    attr->priority = 128;   /* Default priority */
+    attr->priority = SCHED_PRIORITY_DEFAULT; /* Default priority */
     attr->stack_size = 512; /* Default stack (512 bytes) */
     attr->detachstate = PTHREAD_CREATE_JOINABLE;
 
@@ -703,6 +704,8 @@ int pthread_mutexattr_init(pthread_mutexattr_t *attr)
         return EINVAL;
 
     attr->type = PTHREAD_MUTEX_NORMAL;
+    attr->protocol = PTHREAD_PRIO_NONE;
+    attr->prioceiling = SCHED_PRIORITY_MAX;
     attr->initialized = 1;
     return 0;
 }
@@ -738,6 +741,55 @@ int pthread_mutexattr_gettype(const pthread_mutexattr_t *attr, int *type)
     return 0;
 }
 
+__USER_TEXT
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t *attr, int protocol)
+{
+    if (!attr || !attr->initialized)
+        return EINVAL;
+    if (protocol == PTHREAD_PRIO_INHERIT)
+        return ENOTSUP;
+    if (protocol != PTHREAD_PRIO_NONE && protocol != PTHREAD_PRIO_PROTECT)
+        return EINVAL;
+
+    attr->protocol = protocol;
+    return 0;
+}
+
+__USER_TEXT
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t *attr,
+                                  int *protocol)
+{
+    if (!attr || !protocol || !attr->initialized)
+        return EINVAL;
+
+    *protocol = attr->protocol;
+    return 0;
+}
+
+__USER_TEXT
+int pthread_mutexattr_setprioceiling(pthread_mutexattr_t *attr,
+                                     int prioceiling)
+{
+    if (!attr || !attr->initialized)
+        return EINVAL;
+    if (prioceiling < SCHED_PRIORITY_MIN || prioceiling > SCHED_PRIORITY_MAX)
+        return EINVAL;
+
+    attr->prioceiling = prioceiling;
+    return 0;
+}
+
+__USER_TEXT
+int pthread_mutexattr_getprioceiling(const pthread_mutexattr_t *attr,
+                                     int *prioceiling)
+{
+    if (!attr || !prioceiling || !attr->initialized)
+        return EINVAL;
+
+    *prioceiling = attr->prioceiling;
+    return 0;
+}
+
 /* Mutex management functions */
 
 /* Mutex waiter list helpers (spinlock-protected) */
@@ -791,6 +843,90 @@ static L4_ThreadId_t mutex_waiter_pop(pthread_mutex_t *m)
     return tid;
 }
 
+/*
+ * PTHREAD_PRIO_PROTECT mutexes map onto kernel priority-ceiling mutexes.
+ *
+ * The lock word takes KMUTEX_UNLOCKED/LOCKED/CONTENDED. The owner names
+ * the kernel mutex in its UTCB before the LDREX/STREX, so the kernel
+ * raises it to the ceiling at the next scheduling point; neither lock
+ * nor unlock traps unless the mutex is contended or the raise happened.
+ * Nested locks keep the mutex with the highest ceiling named and restore
+ * the previous one on unlock. The ceiling is kept in the mutex object and
+ * next to the handle in the UTCB, so that a mutex shared between address
+ * spaces compares the same in each.
+ */
+#ifdef CONFIG_KMUTEX
+__USER_TEXT
+static int mutex_protect_init(pthread_mutex_t *m, int prioceiling)
+{
+    L4_Word_t ceiling = SCHED_PRIORITY_MAX + 4 - prioceiling;
+    L4_Word_t handle = L4_KMutex(KMUTEX_CREATE, ceiling, 0);
+
+    if (handle == 0)
+        return EAGAIN;
+
+    m->kmutex = handle;
+    m->ceiling = ceiling;
+    m->prioceiling = prioceiling;
+    return 0;
+}
+
+__USER_TEXT
+static int mutex_protect_acquire(pthread_mutex_t *m, int try)
+{
+    uint32_t expected = KMUTEX_UNLOCKED;
+    L4_Word_t prev = __L4_TCR_CeilingMutex();
+    L4_Word_t prev_prio = __L4_TCR_CeilingPrio();
+
+    /* Lower L4 value is the higher ceiling */
+    if (!prev || m->ceiling < prev_prio) {
+        __L4_TCR_Set_CeilingPrio(m->ceiling);
+        __L4_TCR_Set_CeilingMutex(m->kmutex);
+    }
+
+    if (!__atomic_compare_exchange_n(&m->lock, &expected, KMUTEX_LOCKED, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if (try) {
+            __L4_TCR_Set_CeilingMutex(prev);
+            __L4_TCR_Set_CeilingPrio(prev_prio);
+            return EBUSY;
+        }
+
+        /* The owner blocked inside its critical section. Mark the word
+         * contended and sleep in the kernel until it is released.
+         */
+        while (__atomic_exchange_n(&m->lock, KMUTEX_CONTENDED,
+                                   __ATOMIC_ACQUIRE) != KMUTEX_UNLOCKED) {
+            if (L4_KMutex(KMUTEX_WAIT, m->kmutex, (L4_Word_t) &m->lock)) {
+                __L4_TCR_Set_CeilingMutex(prev);
+                __L4_TCR_Set_CeilingPrio(prev_prio);
+                return EINVAL; /* Caller above the ceiling */
+            }
+        }
+    }
+
+    m->ceiling_prev = prev;
+    m->ceiling_prev_prio = prev_prio;
+    m->owner = L4_MyGlobalId();
+    m->count = 1;
+    return 0;
+}
+
+__USER_TEXT
+static void mutex_protect_release(pthread_mutex_t *m)
+{
+    uint32_t old = __atomic_exchange_n(&m->lock, KMUTEX_UNLOCKED,
+                                       __ATOMIC_RELEASE);
+
+    __L4_TCR_Set_CeilingMutex(m->ceiling_prev);
+    __L4_TCR_Set_CeilingPrio(m->ceiling_prev_prio);
+
+    /* Drop the raise and hand over to a sleeping waiter */
+    if (old == KMUTEX_CONTENDED || __L4_TCR_CeilingRaised())
+        L4_KMutex(KMUTEX_WAKE, m->kmutex, 0);
+}
+#endif
+
 /* Internal: Initialize mutex if using static initializer.
  * Uses global spinlock to prevent race between concurrent lazy inits.
  */
@@ -818,6 +954,8 @@ static int pthread_mutex_lazy_init(pthread_mutex_t *mutex)
         mutex->num_waiters = 0;
         for (int i = 0; i < MUTEX_MAX_WAITERS; i++)
             mutex->waiters[i] = L4_nilthread;
+        mutex->protocol = PTHREAD_PRIO_NONE;
+        mutex->kmutex = 0;
         /* Memory barrier before setting initialized flag */
         __atomic_thread_fence(__ATOMIC_RELEASE);
         mutex->initialized = 1;
@@ -845,6 +983,20 @@ int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
     mutex->num_waiters = 0;
     for (int i = 0; i < MUTEX_MAX_WAITERS; i++)
         mutex->waiters[i] = L4_nilthread;
+    mutex->protocol = attr ? attr->protocol : PTHREAD_PRIO_NONE;
+    mutex->prioceiling = 0;
+    mutex->kmutex = 0;
+
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT) {
+#ifdef CONFIG_KMUTEX
+        int ret = mutex_protect_init(mutex, attr->prioceiling);
+        if (ret != 0)
+            return ret;
+#else
+        return ENOTSUP;
+#endif
+    }
+
     mutex->initialized = 1;
 
     return 0;
@@ -863,10 +1015,26 @@ int pthread_mutex_destroy(pthread_mutex_t *mutex)
     if (mutex->lock)
         return EBUSY;
 
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT &&
+        L4_KMutex(KMUTEX_DESTROY, mutex->kmutex, 0) != 0)
+        return EBUSY;
+
     mutex->initialized = 0;
     return 0;
 }
 
+__USER_TEXT
+int pthread_mutex_getprioceiling(const pthread_mutex_t *mutex,
+                                 int *prioceiling)
+{
+    if (!mutex || !prioceiling || !mutex->initialized ||
+        mutex->protocol != PTHREAD_PRIO_PROTECT)
+        return EINVAL;
+
+    *prioceiling = mutex->prioceiling;
+    return 0;
+}
+
 __USER_TEXT
 int pthread_mutex_lock(pthread_mutex_t *mutex)
 {
@@ -894,6 +1062,11 @@ int pthread_mutex_lock(pthread_mutex_t *mutex)
             return EDEADLK;
     }
 
+#ifdef CONFIG_KMUTEX
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT)
+        return mutex_protect_acquire(mutex, 0);
+#endif
+
     /* Blocking mutex acquisition using direct notifications.
      *
      * Fast path: Try atomic acquisition for uncontended case.
@@ -961,6 +1134,11 @@ int pthread_mutex_trylock(pthread_mutex_t *mutex)
         }
     }
 
+#ifdef CONFIG_KMUTEX
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT)
+        return mutex_protect_acquire(mutex, 1);
+#endif
+
     /* ARM LDREX/STREX atomic operation with acquire barrier.
      * Use ITE (If-Then-Else) to always write result:
      * - If lock==0: STREX stores 1, r0 gets STREX result (0=success, 1=fail)
@@ -1024,6 +1202,14 @@ int pthread_mutex_unlock(pthread_mutex_t *mutex)
      */
     mutex->count = 0;
     mutex->owner.raw = 0;
+
+#ifdef CONFIG_KMUTEX
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT) {
+        mutex_protect_release(mutex);
+        return 0;
+    }
+#endif
+
     __asm__ __volatile__("dmb" ::: "memory");
     mutex->lock = 0;
 
@@ -1134,6 +1320,20 @@ int pthread_mutex_timedlock(pthread_mutex_t *mutex,
             return EDEADLK;
     }
 
+#ifdef CONFIG_KMUTEX
+    /* Kernel ceiling mutexes have no timed wait; a PROTECT mutex is only
+     * ever held across a block, so poll until the deadline.
+     */
+    if (mutex->protocol == PTHREAD_PRIO_PROTECT) {
+        while (pthread_mutex_trylock(mutex) != 0) {
+            if (abstime_to_relative_ticks(abstime) == 0)
+                return ETIMEDOUT;
+            L4_Sleep(L4_TimePeriod(1000));
+        }
+        return 0;
+    }
+#endif
+
     /* Fast path: try immediate acquisition */
     if (pthread_mutex_trylock(mutex) == 0) {
         L4_NotifyClear(POSIX_NOTIFY_TIMEOUT_BIT);
@@ -1578,7 +1778,7 @@ int sched_getparam(pid_t pid, struct sched_param *param)
 
     (void) pid;
     /* Return default priority - actual priority stored in TCB */
-    param->sched_priority = 128;
+    param->sched_priority = SCHED_PRIORITY_DEFAULT;
     return 0;
 }
 
@@ -1707,7 +1907,8 @@ int pthread_getschedparam(pthread_t *thread,
         return EINVAL;
 
     *policy = SCHED_FIFO;
-    param->sched_priority = 128; /* Default - would query pager for actual */
+    /* Default - would query pager for actual */
+    param->sched_priority = SCHED_PRIORITY_DEFAULT;
     return 0;
 }
 
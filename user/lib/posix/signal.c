@@ -129,12 +129,14 @@ static struct thread_signal_state *get_thread_signal_state(void)
 /* Deliver signal to a specific thread atomically under lock.
  * Prevents use-after-free by holding lock during find + write.
  * Creates entry for threads without signal state (POSIX requires delivery).
+ * If was_pending is non-NULL, it tells whether sig was already pending.
  * Returns 0 on success, EAGAIN if signal table is full.
  */
 __USER_TEXT
-static int deliver_signal_locked(L4_ThreadId_t tid, int sig)
+static int deliver_signal_locked(L4_ThreadId_t tid, int sig, int *was_pending)
 {
     int free_slot = -1;
+    sigset_t old;
 
     signal_lock_acquire();
 
@@ -144,9 +146,11 @@ static int deliver_signal_locked(L4_ThreadId_t tid, int sig)
             /* Use atomic OR to be consistent with other pending accesses.
              * Lock is held to prevent use-after-free from cleanup.
              */
-            __atomic_fetch_or(&thread_signals[i].pending, (1U << sig),
-                              __ATOMIC_RELEASE);
+            old = __atomic_fetch_or(&thread_signals[i].pending, (1U << sig),
+                                    __ATOMIC_RELEASE);
             signal_lock_release();
+            if (was_pending)
+                *was_pending = (old & (1U << sig)) ? 1 : 0;
             return 0;
         }
         if (free_slot < 0 && thread_signals[i].tid.raw == 0)
@@ -162,6 +166,8 @@ static int deliver_signal_locked(L4_ThreadId_t tid, int sig)
         __atomic_store_n(&thread_signals[free_slot].pending, (1U << sig),
                          __ATOMIC_RELEASE);
         signal_lock_release();
+        if (was_pending)
+            *was_pending = 0;
         return 0;
     }
 
@@ -171,6 +177,17 @@ static int deliver_signal_locked(L4_ThreadId_t tid, int sig)
     return EAGAIN;
 }
 
+/* Deliver sig to tid on behalf of a SIGEV_SIGNAL timer (time.c).
+ * was_pending reports a signal that merged with one not yet taken,
+ * which the timer counts as an overrun.
+ */
+__USER_TEXT
+int __signal_deliver(L4_ThreadId_t tid, int sig, int *was_pending)
+{
+    *was_pending = 0;
+    return deliver_signal_locked(tid, sig, was_pending);
+}
+
 /* Release signal state slot when thread exits.
  * Called from pthread_exit() or thread cleanup.
  */
@@ -373,7 +390,7 @@ int pthread_kill(pthread_t *thread, int sig)
     }
 
     /* Deliver signal atomically under lock to prevent use-after-free. */
-    return deliver_signal_locked(thread->tid, sig);
+    return deliver_signal_locked(thread->tid, sig, NULL);
 }
 
 __USER_TEXT
@@ -4,16 +4,24 @@
  */
 
 #include <l4/ipc.h>
+#include <l4/kip_types.h>
+#include <l4/pager.h>
 #include <l4/platform/syscalls.h>
+#include <l4/schedule.h>
 #include <l4/utcb.h>
 #include <platform/link.h>
+#include <posix/signal.h>
 #include <posix/sys/types.h>
 #include <posix/time.h>
+#include <syscall.h>
+
+/* Signal delivery for SIGEV_SIGNAL timers - defined in signal.c */
+extern int __signal_deliver(L4_ThreadId_t tid, int sig, int *was_pending);
 
 /* Time implementation for PSE51 POSIX_TIMERS compliance
  *
- * Uses L4_SystemClock() syscall for real kernel time.
- * The kernel maintains a microsecond counter from system boot.
+ * Uses L4_SystemClock() for real kernel time. It reads the tick count
+ * the kernel publishes in the KIP, without a syscall.
  *
  * Clock resolution: L4_SystemClock advances at kernel tick rate.
  * With POSIX_USEC_PER_TICK=400, effective resolution is 400µs.
@@ -53,7 +61,7 @@ int clock_gettime(clockid_t clock_id, struct timespec *tp)
     switch (clock_id) {
     case CLOCK_REALTIME:
     case CLOCK_MONOTONIC:
-        /* Use real kernel time via L4_SystemClock syscall.
+        /* Use real kernel time via L4_SystemClock (KIP read).
          * Returns microseconds since system boot.
          */
         {
@@ -116,26 +124,173 @@ int nanosleep(const struct timespec *rqtp, struct timespec *rmtp)
     return 0;
 }
 
-/* Timer implementation - simplified stubs for PSE51 compliance */
+/* Kernel ticks in usec microseconds, rounded up */
+__USER_TEXT
+static uint64_t usec_to_ticks(uint64_t usec)
+{
+    const kip_clock_t *clk = &((kip_t *) &kip_start)->clock;
+
+    return ((usec << KIP_CLOCK_SHIFT) + clk->usec_per_tick - 1) /
+           clk->usec_per_tick;
+}
+
+__USER_TEXT
+static uint64_t timespec_to_ticks(const struct timespec *ts)
+{
+    return usec_to_ticks((uint64_t) ts->tv_sec * USEC_PER_SEC +
+                         ts->tv_nsec / NSEC_PER_USEC);
+}
+
+__USER_TEXT
+static void ticks_to_timespec(uint64_t ticks, struct timespec *ts)
+{
+    const kip_clock_t *clk = &((kip_t *) &kip_start)->clock;
+    uint64_t usec = (ticks * clk->usec_per_tick) >> KIP_CLOCK_SHIFT;
+
+    ts->tv_sec = usec / USEC_PER_SEC;
+    ts->tv_nsec = (usec % USEC_PER_SEC) * NSEC_PER_USEC;
+}
+
+/* With TIMER_ABSTIME, sleep until rqtp on the clock rather than for it.
+ *
+ * Under CONFIG_PERIODIC_RELEASE the wakeup is a one-shot kernel release
+ * at the first tick at or after rqtp, so the time between reading the
+ * clock and blocking cannot push it back. The kernel refuses it to EDF
+ * and time-triggered threads and to threads with periodic releases
+ * armed, whose release bit it would take over. Then, and for deadlines
+ * the release can't reach, it sleeps for the time left.
+ */
+__USER_TEXT
+int clock_nanosleep(clockid_t clock_id,
+                    int flags,
+                    const struct timespec *rqtp,
+                    struct timespec *rmtp)
+{
+    struct timespec rel;
+    uint64_t usec, now;
+
+    if (!rqtp || rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1000000000)
+        return EINVAL;
+
+    if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC)
+        return EINVAL;
+
+    if (!(flags & TIMER_ABSTIME))
+        return nanosleep(rqtp, rmtp);
+
+    usec = (uint64_t) rqtp->tv_sec * USEC_PER_SEC +
+           rqtp->tv_nsec / NSEC_PER_USEC;
+
+#ifdef CONFIG_PERIODIC_RELEASE
+    {
+        uint64_t tick = usec_to_ticks(usec);
+
+        if (tick <= L4_SystemClockTicks())
+            return 0;
+
+        if (L4_Release(RELEASE_SET, tick, 0) == 0) {
+            L4_Release(RELEASE_WAIT, 0, 0);
+            return 0;
+        }
+    }
+#endif
+
+    now = L4_SystemClock().raw;
+    if (usec <= now)
+        return 0;
+
+    rel.tv_sec = (usec - now) / USEC_PER_SEC;
+    rel.tv_nsec = ((usec - now) % USEC_PER_SEC) * NSEC_PER_USEC;
+    return nanosleep(&rel, NULL);
+}
 
-/* Static timer storage - limited number of timers
- * Must use __USER_BSS to place in user-accessible memory region.
+/* Timers
+ *
+ * Each timer is a kernel notification timer (L4_TimerNotify) posting one
+ * bit to a dispatcher thread. A dispatcher serves a group of
+ * TIMER_GROUP_SIZE timers, one notification bit each, and is started with
+ * the first timer of its group. It alone arms and cancels its kernel
+ * timers: timer_settime() and timer_delete() record the new state and
+ * post TIMER_CTL_BIT, and the dispatcher applies it. Once armed, a
+ * periodic timer costs no syscall per period but the dispatcher's wait.
+ *
+ * Expiries are delivered by the dispatcher: SIGEV_SIGNAL marks the signal
+ * pending on the thread that created the timer, SIGEV_THREAD queues the
+ * timer to a pool of TIMER_HELPERS threads that run the callbacks. A timer
+ * is queued at most once; an expiry that finds its last delivery still
+ * pending or queued counts as an overrun instead, as do the periods the
+ * kernel saw go by with the dispatcher's bit still set.
+ *
+ * All timer state is shared under timer_table_lock, which is never held
+ * across a kernel call: timer_settime() and timer_delete() post after
+ * releasing it, and the dispatcher plans its kernel timer work under it
+ * and carries it out afterwards (see timer_dispatcher()).
  */
-#define MAX_TIMERS 4
-__USER_BSS static struct {
-    int active;
-    clockid_t clock_id;
-    struct itimerspec value;
-} timer_table[MAX_TIMERS];
-
-/* Spinlock for timer slot allocation to prevent race conditions */
+#define TIMER_GROUP_SIZE 30
+#define TIMER_GROUPS 2
+#define MAX_TIMERS (TIMER_GROUP_SIZE * TIMER_GROUPS)
+#define TIMER_CTL_BIT (1U << TIMER_GROUP_SIZE)
+#define TIMER_GROUP_MASK (TIMER_CTL_BIT - 1)
+#define TIMER_HELPERS 2
+#define TIMER_OVERRUN_MAX 0x7FFFFFFF
+
+/* timer_group.state */
+#define TIMER_GROUP_IDLE 0
+#define TIMER_GROUP_STARTING 1
+#define TIMER_GROUP_RUNNING 2
+
+struct posix_timer {
+    uint8_t active;
+    uint8_t notify;   /* SIGEV_* */
+    uint8_t queued;   /* SIGEV_THREAD delivery queued or running */
+    uint8_t periodic; /* handle is a periodic kernel timer */
+    int signo;
+    union sigval value;
+    void (*function)(union sigval);
+    L4_ThreadId_t owner; /* SIGEV_SIGNAL target */
+    uint64_t expiry;     /* Next expiry in ticks, 0 while disarmed */
+    uint32_t interval;   /* Ticks, 0 for a one-shot timer */
+    uint32_t slack;      /* Ticks, see timer_setslack_np() */
+    uint32_t seq;        /* Bumped when the dispatcher has work */
+    uint32_t applied;    /* seq the kernel timer was armed for */
+    L4_Word_t handle;    /* Kernel timer, 0 if none */
+    int overrun;
+};
+
+struct timer_group {
+    uint32_t state;
+    L4_ThreadId_t tid; /* Dispatcher */
+};
+
+/* Kernel timer work a dispatcher planned under the lock for one timer */
+struct timer_op {
+    L4_Word_t cancel; /* Handle to cancel, 0 for none */
+    L4_Word_t ticks;  /* Arm a kernel timer for this many ticks, or 0 */
+    L4_Word_t flags;  /* TIMER_NOTIFY_* of the new kernel timer */
+    L4_Word_t extra;  /* Periods the old periodic kernel timer merged */
+    uint32_t seq;     /* t->seq the new kernel timer is for */
+    uint8_t clear;    /* Clear the timer's bit after cancelling */
+};
+
+/* Must use __USER_BSS to place in user-accessible memory region. */
+__USER_BSS static struct posix_timer timer_table[MAX_TIMERS];
+__USER_BSS static struct timer_group timer_groups[TIMER_GROUPS];
+__USER_BSS static struct timer_op timer_ops[TIMER_GROUPS][TIMER_GROUP_SIZE];
+
+/* SIGEV_THREAD helpers and the ring of timers queued to them */
+__USER_BSS static struct timer_group timer_helper_pool;
+__USER_BSS static L4_ThreadId_t timer_helpers[TIMER_HELPERS];
+__USER_BSS static uint8_t timer_ring[MAX_TIMERS];
+__USER_BSS static uint32_t timer_ring_head, timer_ring_count;
+
+/* Spinlock for timer state, shared with dispatchers and helpers */
 __USER_BSS static uint32_t timer_table_lock;
 
 __USER_TEXT
 static void timer_lock_acquire(void)
 {
     while (__atomic_exchange_n(&timer_table_lock, 1, __ATOMIC_ACQUIRE))
-        ;
+        L4_Yield();
 }
 
 __USER_TEXT
@@ -145,10 +300,321 @@ static void timer_lock_release(void)
 }
 
 __USER_TEXT
-int timer_create(clockid_t clock_id, struct sigevent *evp, timer_t *timerid)
+static struct posix_timer *timer_lookup(timer_t timerid)
+{
+    int idx = (int) timerid;
+
+    if (idx < 0 || idx >= MAX_TIMERS || !timer_table[idx].active)
+        return NULL;
+    return &timer_table[idx];
+}
+
+/* Start the thread(s) behind g once, running entry(arg) on each of n
+ * threads, the first recorded in g->tid. Returns 0 once they run.
+ */
+__USER_TEXT
+static int timer_group_start(struct timer_group *g,
+                             void *(*entry)(void *),
+                             void *arg,
+                             int n)
 {
+    uint32_t idle = TIMER_GROUP_IDLE;
+    L4_ThreadId_t tid;
     int i;
-    int result = EAGAIN; /* No timer slots available */
+
+    if (__atomic_compare_exchange_n(&g->state, &idle, TIMER_GROUP_STARTING,
+                                    0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        for (i = 0; i < n; i++) {
+            tid = pager_create_thread();
+            if (tid.raw == 0)
+                break;
+            if (i == 0)
+                g->tid = tid;
+            pager_start_thread(tid, entry, arg);
+        }
+
+        /* A pool short of n threads still serves, just less in parallel */
+        __atomic_store_n(&g->state,
+                         i ? TIMER_GROUP_RUNNING : TIMER_GROUP_IDLE,
+                         __ATOMIC_RELEASE);
+        return i ? 0 : EAGAIN;
+    }
+
+    while ((idle = __atomic_load_n(&g->state, __ATOMIC_ACQUIRE)) ==
+           TIMER_GROUP_STARTING)
+        L4_Yield();
+    return (idle == TIMER_GROUP_RUNNING) ? 0 : EAGAIN;
+}
+
+__USER_TEXT
+static void *timer_helper(void *arg)
+{
+    L4_ThreadId_t self = L4_MyGlobalId();
+    struct posix_timer *t;
+    void (*function)(union sigval);
+    union sigval value;
+    int i;
+
+    timer_lock_acquire();
+    for (i = 0; i < TIMER_HELPERS; i++) {
+        if (timer_helpers[i].raw == 0) {
+            timer_helpers[i] = self;
+            break;
+        }
+    }
+    timer_lock_release();
+
+    while (1) {
+        timer_lock_acquire();
+        if (!timer_ring_count) {
+            timer_lock_release();
+            L4_NotifyWait(POSIX_NOTIFY_TIMER_BIT);
+            continue;
+        }
+
+        t = &timer_table[timer_ring[timer_ring_head]];
+        timer_ring_head = (timer_ring_head + 1) % MAX_TIMERS;
+        --timer_ring_count;
+
+        /* Deleted while queued: timer_create() skips it until now */
+        function = t->active ? t->function : NULL;
+        value = t->value;
+        timer_lock_release();
+
+        if (function)
+            function(value);
+
+        timer_lock_acquire();
+        t->queued = 0;
+        timer_lock_release();
+    }
+
+    return NULL;
+}
+
+/* Hand an expiry to its thread or signal; extra periods went by unseen.
+ * Called with the lock held. Returns 1 if the helpers need waking.
+ */
+__USER_TEXT
+static int timer_deliver(struct posix_timer *t, uint32_t extra)
+{
+    int pending = 0, wake = 0;
+    uint64_t overrun;
+
+    if (t->notify == SIGEV_THREAD && t->queued) {
+        pending = 1;
+    } else if (t->notify == SIGEV_THREAD) {
+        t->queued = 1;
+        timer_ring[(timer_ring_head + timer_ring_count) % MAX_TIMERS] =
+            t - timer_table;
+        ++timer_ring_count;
+        wake = 1;
+    } else if (t->notify == SIGEV_SIGNAL) {
+        __signal_deliver(t->owner, t->signo, &pending);
+    }
+
+    overrun = extra + (pending ? (uint64_t) t->overrun + 1 : 0);
+    t->overrun = (overrun > TIMER_OVERRUN_MAX) ? TIMER_OVERRUN_MAX : overrun;
+    return wake;
+}
+
+/* Plan arming the kernel timer for t->expiry. A one-shot kernel timer
+ * leads up to the first expiry, and a periodic one armed from there takes
+ * over. Called by the dispatcher with the lock held.
+ */
+__USER_TEXT
+static void timer_arm(struct posix_timer *t,
+                      struct timer_op *op,
+                      uint64_t now,
+                      int periodic)
+{
+    uint64_t ticks = (t->expiry > now) ? t->expiry - now : 1;
+
+    op->flags = TIMER_NOTIFY_SLACK(t->slack);
+    if (periodic)
+        op->flags |= TIMER_NOTIFY_PERIODIC;
+
+    /* Far deadlines take several one-shots; see timer_expire() */
+    op->ticks = (ticks > 0xFFFFFFFF) ? 0xFFFFFFFF : (L4_Word_t) ticks;
+    op->seq = t->seq;
+    t->periodic = periodic;
+}
+
+/* Called by the dispatcher with the lock held; op->extra holds the
+ * periods a periodic kernel timer merged. Returns 1 if the helpers need
+ * waking.
+ */
+__USER_TEXT
+static int timer_expire(struct posix_timer *t,
+                        struct timer_op *op,
+                        uint64_t now)
+{
+    L4_Word_t extra = 0;
+
+    if (!t->active || !t->expiry)
+        return 0;
+
+    if (t->periodic) {
+        extra = op->extra;
+        t->expiry += (uint64_t) (1 + extra) * t->interval;
+    } else {
+        /* A one-shot kernel timer is gone once it fires */
+        t->handle = 0;
+
+        /* Not due yet: batched early with another timer, or far out */
+        if (now < t->expiry) {
+            timer_arm(t, op, now, 0);
+            return 0;
+        }
+
+        /* The periods now count from here: late by the dispatch latency
+         * once, but not again.
+         */
+        if (t->interval) {
+            extra = (now - t->expiry) / t->interval;
+            t->expiry = now + t->interval;
+            timer_arm(t, op, now, 1);
+        } else {
+            t->expiry = 0;
+        }
+    }
+
+    return timer_deliver(t, extra);
+}
+
+/* Plan applying timer_settime()/timer_delete() to the kernel timer of t.
+ * Called by the dispatcher with the lock held.
+ */
+__USER_TEXT
+static void timer_apply(struct posix_timer *t,
+                        struct timer_op *op,
+                        uint64_t now)
+{
+    op->cancel = t->handle;
+    op->clear = 1;
+    t->handle = 0;
+
+    t->applied = t->seq;
+    t->periodic = 0;
+    if (t->active && t->expiry)
+        timer_arm(t, op, now, 0);
+}
+
+/* Carry out op for t, outside the lock */
+__USER_TEXT
+static void timer_op_run(struct posix_timer *t,
+                         struct timer_op *op,
+                         L4_Word_t bit)
+{
+    if (op->cancel)
+        L4_TimerControl(TIMER_CANCEL, op->cancel);
+    if (op->clear)
+        L4_NotifyClear(bit);
+    if (!op->ticks)
+        return;
+
+    t->handle = L4_TimerNotify(op->ticks, bit, op->flags);
+    if (!t->handle) {
+        /* Out of kernel timers: the timer reads as disarmed, unless it
+         * has been set again meanwhile
+         */
+        timer_lock_acquire();
+        if (t->seq == op->seq)
+            t->expiry = 0;
+        t->periodic = 0;
+        timer_lock_release();
+    }
+}
+
+/* Each round takes the lock once to update the timers and plan the kernel
+ * timer work, then makes the kernel calls with the lock released: a
+ * client spinning on the lock at a higher priority would otherwise keep
+ * the dispatcher from finishing them. handle and periodic are only
+ * changed by the dispatcher, so it reads them without the lock.
+ */
+__USER_TEXT
+static void *timer_dispatcher(void *arg)
+{
+    struct posix_timer *group = (struct posix_timer *) arg;
+    struct timer_op *ops = timer_ops[(group - timer_table) / TIMER_GROUP_SIZE];
+    L4_Word_t bits, extra;
+    uint64_t now;
+    int i, wake;
+
+    while (1) {
+        bits = L4_NotifyWait(TIMER_GROUP_MASK | TIMER_CTL_BIT);
+        now = L4_SystemClockTicks();
+
+        for (i = 0; i < TIMER_GROUP_SIZE; i++) {
+            ops[i].cancel = 0;
+            ops[i].ticks = 0;
+            ops[i].extra = 0;
+            ops[i].clear = 0;
+            if ((bits & (1UL << i)) && group[i].periodic) {
+                extra = L4_TimerControl(TIMER_OVERRUN, group[i].handle);
+                ops[i].extra = (extra == ~0UL) ? 0 : extra;
+            }
+        }
+
+        wake = 0;
+        timer_lock_acquire();
+        if (bits & TIMER_CTL_BIT) {
+            for (i = 0; i < TIMER_GROUP_SIZE; i++) {
+                if (group[i].applied != group[i].seq) {
+                    /* An expiry in hand is of the old setting */
+                    bits &= ~(1UL << i);
+                    timer_apply(&group[i], &ops[i], now);
+                }
+            }
+        }
+        for (i = 0; i < TIMER_GROUP_SIZE; i++)
+            if (bits & (1UL << i))
+                wake |= timer_expire(&group[i], &ops[i], now);
+        timer_lock_release();
+
+        for (i = 0; i < TIMER_GROUP_SIZE; i++)
+            timer_op_run(&group[i], &ops[i], 1UL << i);
+
+        for (i = 0; wake && i < TIMER_HELPERS; i++)
+            if (timer_helpers[i].raw)
+                L4_NotifyPost(timer_helpers[i], POSIX_NOTIFY_TIMER_BIT);
+    }
+
+    return NULL;
+}
+
+/* Hand t's new state to its dispatcher. The caller records it under the
+ * lock, bumping t->seq, and kicks after releasing the lock.
+ */
+__USER_TEXT
+static void timer_kick(struct posix_timer *t)
+{
+    L4_NotifyPost(timer_groups[(t - timer_table) / TIMER_GROUP_SIZE].tid,
+                  TIMER_CTL_BIT);
+}
+
+__USER_TEXT
+static void timer_remaining(struct posix_timer *t,
+                            uint64_t now,
+                            struct itimerspec *value)
+{
+    uint64_t expiry = t->expiry;
+
+    /* The dispatcher may not have caught up with a periodic timer yet */
+    if (expiry && t->interval && expiry <= now)
+        expiry += ((now - expiry) / t->interval + 1) * t->interval;
+
+    ticks_to_timespec(expiry > now ? expiry - now : 0, &value->it_value);
+    ticks_to_timespec(t->interval, &value->it_interval);
+    if (expiry && expiry <= now)
+        value->it_value.tv_nsec = 1; /* Due, but still armed */
+}
+
+__USER_TEXT
+int timer_create(clockid_t clock_id, struct sigevent *evp, timer_t *timerid)
+{
+    struct posix_timer *t = NULL;
+    int i, result;
 
     if (!timerid)
         return EINVAL;
@@ -156,89 +622,205 @@ int timer_create(clockid_t clock_id, struct sigevent *evp, timer_t *timerid)
     if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC)
         return EINVAL;
 
+    if (evp && evp->sigev_notify == SIGEV_SIGNAL &&
+        (evp->sigev_signo < 1 || evp->sigev_signo > 31))
+        return EINVAL;
+
+    if (evp && evp->sigev_notify == SIGEV_THREAD) {
+        if (!evp->sigev_notify_function)
+            return EINVAL;
+        result = timer_group_start(&timer_helper_pool, timer_helper, NULL,
+                                   TIMER_HELPERS);
+        if (result)
+            return result;
+    } else if (evp && evp->sigev_notify != SIGEV_SIGNAL &&
+               evp->sigev_notify != SIGEV_NONE) {
+        return EINVAL;
+    }
+
     /* Find free timer slot under lock to prevent race conditions */
     timer_lock_acquire();
-
     for (i = 0; i < MAX_TIMERS; i++) {
-        if (!timer_table[i].active) {
-            timer_table[i].active = 1;
-            timer_table[i].clock_id = clock_id;
-            timer_table[i].value.it_value.tv_sec = 0;
-            timer_table[i].value.it_value.tv_nsec = 0;
-            timer_table[i].value.it_interval.tv_sec = 0;
-            timer_table[i].value.it_interval.tv_nsec = 0;
-            *timerid = (timer_t) i;
-            result = 0;
+        /* A deleted timer stays busy while its callback is queued */
+        if (!timer_table[i].active && !timer_table[i].queued) {
+            t = &timer_table[i];
+            t->active = 1;
             break;
         }
     }
+    timer_lock_release();
+
+    if (!t)
+        return EAGAIN; /* No timer slots available */
+
+    result = timer_group_start(&timer_groups[i / TIMER_GROUP_SIZE],
+                               timer_dispatcher,
+                               &timer_table[i - i % TIMER_GROUP_SIZE], 1);
+    if (result) {
+        timer_lock_acquire();
+        t->active = 0;
+        timer_lock_release();
+        return result;
+    }
 
+    /* Without evp, SIGALRM to the caller with the timer ID as value */
+    timer_lock_acquire();
+    t->notify = evp ? evp->sigev_notify : SIGEV_SIGNAL;
+    t->signo = evp ? evp->sigev_signo : SIGALRM;
+    if (evp)
+        t->value = evp->sigev_value;
+    else
+        t->value.sival_int = i;
+    t->function = evp ? evp->sigev_notify_function : NULL;
+    t->owner = L4_MyGlobalId();
+    t->expiry = 0;
+    t->interval = 0;
+    t->slack = 0;
+    t->overrun = 0;
     timer_lock_release();
-    return result;
+
+    *timerid = (timer_t) i;
+    return 0;
 }
 
 __USER_TEXT
 int timer_delete(timer_t timerid)
 {
-    int idx = (int) timerid;
+    struct posix_timer *t;
 
-    if (idx < 0 || idx >= MAX_TIMERS || !timer_table[idx].active)
+    timer_lock_acquire();
+    t = timer_lookup(timerid);
+    if (!t) {
+        timer_lock_release();
         return EINVAL;
+    }
 
-    timer_table[idx].active = 0;
+    t->active = 0;
+    t->expiry = 0;
+    ++t->seq;
+    timer_lock_release();
+
+    timer_kick(t);
     return 0;
 }
 
+/* The kernel timer is armed asynchronously by the dispatcher, so a
+ * relative it_value counts from this call. If the kernel has no timer
+ * left to arm, the timer reads as disarmed in timer_gettime().
+ */
 __USER_TEXT
 int timer_settime(timer_t timerid,
                   int flags,
                   const struct itimerspec *value,
                   struct itimerspec *ovalue)
 {
-    int idx = (int) timerid;
+    struct posix_timer *t;
+    uint64_t now, expiry, interval;
 
-    if (idx < 0 || idx >= MAX_TIMERS || !timer_table[idx].active)
+    if (!value || value->it_value.tv_sec < 0 || value->it_value.tv_nsec < 0 ||
+        value->it_value.tv_nsec >= 1000000000 ||
+        value->it_interval.tv_sec < 0 || value->it_interval.tv_nsec < 0 ||
+        value->it_interval.tv_nsec >= 1000000000)
         return EINVAL;
 
-    if (!value)
+    /* Non-zero times take at least a tick */
+    expiry = timespec_to_ticks(&value->it_value);
+    if (!expiry && (value->it_value.tv_sec || value->it_value.tv_nsec))
+        expiry = 1;
+    interval = timespec_to_ticks(&value->it_interval);
+    if (!interval && (value->it_interval.tv_sec || value->it_interval.tv_nsec))
+        interval = 1;
+    if (interval > 0xFFFFFFFF)
         return EINVAL;
 
-    if (ovalue) {
-        *ovalue = timer_table[idx].value;
+    timer_lock_acquire();
+    t = timer_lookup(timerid);
+    if (!t) {
+        timer_lock_release();
+        return EINVAL;
     }
 
-    timer_table[idx].value = *value;
+    now = L4_SystemClockTicks();
+    if (ovalue)
+        timer_remaining(t, now, ovalue);
 
-    /* FIXME: Actual timer firing not implemented - would require
-     * kernel timer integration or periodic polling.
-     */
+    /* A zero it_value disarms; an absolute time already past is due now */
+    if (expiry && !(flags & TIMER_ABSTIME))
+        expiry += now;
+    else if (expiry && expiry <= now)
+        expiry = now;
 
+    t->expiry = expiry;
+    t->interval = expiry ? (uint32_t) interval : 0;
+    t->overrun = 0;
+    ++t->seq;
+    timer_lock_release();
+
+    timer_kick(t);
     return 0;
 }
 
+/* Non-portable: let each expiry of the timer come up to slack late, so
+ * that the kernel can batch it with other timers (TIMER_NOTIFY_SLACK).
+ * Takes effect at the next timer_settime().
+ */
 __USER_TEXT
-int timer_gettime(timer_t timerid, struct itimerspec *value)
+int timer_setslack_np(timer_t timerid, const struct timespec *slack)
 {
-    int idx = (int) timerid;
+    const kip_clock_t *clk = &((kip_t *) &kip_start)->clock;
+    struct posix_timer *t;
+    uint64_t ticks;
 
-    if (idx < 0 || idx >= MAX_TIMERS || !timer_table[idx].active)
+    if (!slack || slack->tv_sec < 0 || slack->tv_nsec < 0 ||
+        slack->tv_nsec >= 1000000000)
         return EINVAL;
 
+    /* Rounded down: the slack is a bound on lateness */
+    ticks = (((uint64_t) slack->tv_sec * USEC_PER_SEC +
+              slack->tv_nsec / NSEC_PER_USEC)
+             << KIP_CLOCK_SHIFT) /
+            clk->usec_per_tick;
+
+    timer_lock_acquire();
+    t = timer_lookup(timerid);
+    if (t)
+        t->slack = (ticks > 0xFFFF) ? 0xFFFF : (uint32_t) ticks;
+    timer_lock_release();
+
+    return t ? 0 : EINVAL;
+}
+
+__USER_TEXT
+int timer_gettime(timer_t timerid, struct itimerspec *value)
+{
+    struct posix_timer *t;
+
     if (!value)
         return EINVAL;
 
-    *value = timer_table[idx].value;
-    return 0;
+    timer_lock_acquire();
+    t = timer_lookup(timerid);
+    if (t)
+        timer_remaining(t, L4_SystemClockTicks(), value);
+    timer_lock_release();
+
+    return t ? 0 : EINVAL;
 }
 
+/* Expiries lost to the last delivery: those that came while it was still
+ * pending, and the periods the dispatcher was too late to see.
+ */
 __USER_TEXT
 int timer_getoverrun(timer_t timerid)
 {
-    int idx = (int) timerid;
+    struct posix_timer *t;
+    int overrun = -1;
 
-    if (idx < 0 || idx >= MAX_TIMERS || !timer_table[idx].active)
-        return -1;
+    timer_lock_acquire();
+    t = timer_lookup(timerid);
+    if (t)
+        overrun = t->overrun;
+    timer_lock_release();
 
-    /* Overrun tracking not implemented */
-    return 0;
+    return overrun;
 }